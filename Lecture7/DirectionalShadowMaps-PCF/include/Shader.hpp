@@ -62,6 +62,10 @@ public:
 
     void set_directional_shadow_map(GLenum texture_unit) const noexcept;
 
+    void set_directional_shadow_comparison(GLenum texture_unit) const noexcept;
+
+    void set_pcf_mode(GLint mode) const noexcept;
+
     void set_directional_light_space_transform(const glm::mat4& directional_light_space_transform) const noexcept;
 
 private:
@@ -82,6 +86,8 @@ private:
     GLuint uniform_specular_shininess_id{0};
     GLuint uniform_directional_light_space_transform_id{0};
     GLuint uniform_directional_shadow_map_id{0};
+    GLuint uniform_directional_shadow_comparison_id{0};
+    GLuint uniform_pcf_mode_id{0};
     GLuint uniform_texture_id{0};
     
     struct
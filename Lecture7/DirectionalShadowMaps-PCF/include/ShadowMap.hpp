@@ -7,6 +7,15 @@
 class ShadowMap
 {
 public:
+    // How the lighting shader filters depth comparisons
+    enum class PCFMode
+    {
+        NONE,             // One comparison
+        MANUAL_3X3,       // Nine fetches compared in the shader
+        HARDWARE_2X2,     // One comparison sampler fetch, bilinear 2x2 PCF
+        HARDWARE_POISSON  // Nine comparison sampler fetches on a Poisson disk
+    };
+
     ShadowMap() = default;
 
     virtual ~ShadowMap();
@@ -17,11 +26,16 @@ public:
 
     virtual void read(GLenum texture_unit) noexcept;
 
+    // Binds the map with a depth-comparison sampler, for sampler2DShadow lookups
+    void read_comparison(GLenum texture_unit) noexcept;
+
     GLuint get_width() const noexcept { return width; }
 
     GLuint get_height() const noexcept { return height; }
 
 private:
+    static GLuint get_comparison_sampler() noexcept;
+
     GLuint FBO_id{0};
     GLuint shadow_map_id{0};
     GLuint width{0};
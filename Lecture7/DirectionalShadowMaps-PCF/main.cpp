@@ -1,3 +1,4 @@
+#include <array>
 #include <iostream>
 #include <string>
 
@@ -13,6 +14,7 @@
 #include <Material.hpp>
 #include <Mesh.hpp>
 #include <Model.hpp>
+#include <PassTimer.hpp>
 #include <PointLight.hpp>
 #include <Shader.hpp>
 #include <SpotLight.hpp>
@@ -40,6 +42,10 @@ struct Data
     static const fs::path directional_shadow_map_vertex_shader_path;
     static const fs::path directional_shadow_map_fragment_shader_path;
 
+    static ShadowMap::PCFMode pcf_mode;
+    static std::shared_ptr<PassTimer> lighting_timer;
+    static std::array<bool, 1024> previous_keys;
+
     // Shader variable locations
     static GLuint uniform_projection_id;
     static GLuint uniform_model_id;
@@ -66,6 +72,10 @@ const fs::path Data::fragment_shader_path{Data::root_path / "shaders" / "shader.
 const fs::path Data::directional_shadow_map_vertex_shader_path{Data::root_path / "shaders" / "directional_shadow_map.vert"};
 const fs::path Data::directional_shadow_map_fragment_shader_path{Data::root_path / "shaders" / "directional_shadow_map.frag"};
 
+ShadowMap::PCFMode Data::pcf_mode{ShadowMap::PCFMode::MANUAL_3X3};
+std::shared_ptr<PassTimer> Data::lighting_timer{nullptr};
+std::array<bool, 1024> Data::previous_keys{};
+
 GLuint Data::uniform_projection_id{0};
 GLuint Data::uniform_model_id{0};
 GLuint Data::uniform_view_id{0};
@@ -226,6 +236,43 @@ void directional_shadow_map_pass(std::shared_ptr<DirectionalLight> light) noexce
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+std::string pcf_mode_name(ShadowMap::PCFMode mode) noexcept
+{
+    switch (mode)
+    {
+        case ShadowMap::PCFMode::NONE:
+            return "no PCF";
+
+        case ShadowMap::PCFMode::MANUAL_3X3:
+            return "manual 3x3 PCF";
+
+        case ShadowMap::PCFMode::HARDWARE_2X2:
+            return "hardware 2x2 PCF";
+
+        case ShadowMap::PCFMode::HARDWARE_POISSON:
+            return "hardware Poisson PCF";
+    }
+
+    return "";
+}
+
+void handle_render_options(const std::array<bool, 1024>& keys) noexcept
+{
+    LOG_INIT_COUT();
+
+    // P cycles the PCF mode; the lighting timer reports each mode separately
+    if (keys[GLFW_KEY_P] && !Data::previous_keys[GLFW_KEY_P])
+    {
+        Data::pcf_mode = static_cast<ShadowMap::PCFMode>((static_cast<int>(Data::pcf_mode) + 1) % 4);
+
+        std::string name = pcf_mode_name(Data::pcf_mode);
+        log(LOG_INFO) << "Shadow PCF: " << name << "\n";
+        Data::lighting_timer->reset("Lighting (" + name + ")");
+    }
+
+    Data::previous_keys = keys;
+}
+
 void render_pass(const glm::mat4& projection, const glm::mat4& view) noexcept
 {
     Data::shader_list[0]->use();
@@ -256,6 +303,11 @@ void render_pass(const glm::mat4& projection, const glm::mat4& view) noexcept
     Data::shader_list[0]->set_texture(0);
     Data::shader_list[0]->set_directional_shadow_map(1);
 
+    // The same depth texture again, through a comparison sampler
+    Data::main_light->get_shadow_map()->read_comparison(GL_TEXTURE2);
+    Data::shader_list[0]->set_directional_shadow_comparison(2);
+    Data::shader_list[0]->set_pcf_mode(static_cast<GLint>(Data::pcf_mode));
+
     auto lower_light = Data::camera->get_position();
     lower_light.y -= 0.3f;
     Data::spot_lights[0]->set(lower_light, Data::camera->get_direction());
@@ -321,6 +373,8 @@ int main()
         )
     );
 
+    Data::lighting_timer = std::make_shared<PassTimer>("Lighting (" + pcf_mode_name(Data::pcf_mode) + ")");
+
     glm::mat4 projection = glm::perspective(glm::radians(45.f), main_window->get_aspect_ratio(), 0.1f, 100.f);
 
     GLfloat last_time = glfwGetTime();
@@ -338,8 +392,13 @@ int main()
         Data::camera->handle_mouse(main_window->get_x_change(), main_window->get_y_change());
         Data::camera->update(dt);
 
+        handle_render_options(main_window->get_keys());
+
         directional_shadow_map_pass(Data::main_light);  
+
+        Data::lighting_timer->begin();
         render_pass(projection, Data::camera->get_view_matrix());
+        Data::lighting_timer->end();
 
         glUseProgram(0);
 
@@ -10,6 +10,14 @@ out vec4 color;
 const int MAX_POINT_LIGHTS = 10;
 const int MAX_SPOT_LIGHTS = 10;
 
+// Must match ShadowMap::PCFMode
+const int PCF_NONE = 0;
+const int PCF_MANUAL_3X3 = 1;
+const int PCF_HARDWARE_2X2 = 2;
+const int PCF_HARDWARE_POISSON = 3;
+const int POISSON_SAMPLES = 9;
+const float POISSON_RADIUS = 1.5; // In texels
+
 struct Light
 {
     vec3 color;
@@ -53,11 +61,20 @@ uniform int num_spot_lights;
 
 uniform sampler2D the_texture;
 uniform sampler2D directional_shadow_map;
+uniform sampler2DShadow directional_shadow_comparison;
+uniform int pcf_mode;
 
 uniform Material material;
 
 uniform vec3 eye_position;
 
+vec2 poisson_disk[POISSON_SAMPLES] = vec2[]
+(
+   vec2(0.0, 0.0), vec2(-0.94201624, -0.39906216), vec2(0.94558609, -0.76890725),
+   vec2(-0.09418410, -0.92938870), vec2(0.34495938, 0.29387760), vec2(-0.91588581, 0.45771432),
+   vec2(-0.81544232, -0.87912464), vec2(-0.38277543, 0.27676845), vec2(0.97484398, 0.75648379)
+);
+
 float calculate_directional_shadow_factor(DirectionalLight light)
 {
     vec3 projection_coordinates = directional_light_space_pos.xyz / directional_light_space_pos.w;
@@ -74,16 +91,39 @@ float calculate_directional_shadow_factor(DirectionalLight light)
 
     vec2 texel_size = 1.0 / textureSize(directional_shadow_map, 0);
 
-    for (int x = -1; x <= 1; ++x)
+    if (pcf_mode == PCF_NONE)
+    {
+        float closest = texture(directional_shadow_map, projection_coordinates.xy).r;
+        shadow = current - bias > closest ? 1.0 : 0.0;
+    }
+    else if (pcf_mode == PCF_HARDWARE_2X2)
+    {
+        // The comparison sampler filters the four nearest comparisons
+        shadow = 1.0 - texture(directional_shadow_comparison, vec3(projection_coordinates.xy, current - bias));
+    }
+    else if (pcf_mode == PCF_HARDWARE_POISSON)
     {
-        for (int y = -1; y <= 1; ++y)
+        for (int i = 0; i < POISSON_SAMPLES; ++i)
         {
-            float pcf_depth = texture(directional_shadow_map, projection_coordinates.xy + vec2(x, y) * texel_size).r;
-            shadow += current - bias > pcf_depth ? 1.0 : 0.0;
+            vec2 coordinates = projection_coordinates.xy + poisson_disk[i] * POISSON_RADIUS * texel_size;
+            shadow += 1.0 - texture(directional_shadow_comparison, vec3(coordinates, current - bias));
         }
+
+        shadow /= POISSON_SAMPLES;
     }
+    else
+    {
+        for (int x = -1; x <= 1; ++x)
+        {
+            for (int y = -1; y <= 1; ++y)
+            {
+                float pcf_depth = texture(directional_shadow_map, projection_coordinates.xy + vec2(x, y) * texel_size).r;
+                shadow += current - bias > pcf_depth ? 1.0 : 0.0;
+            }
+        }
 
-    shadow /= 9;
+        shadow /= 9;
+    }
 
     if (projection_coordinates.z > 1.0)
     {
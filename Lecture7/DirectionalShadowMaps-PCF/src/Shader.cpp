@@ -67,6 +67,16 @@ void Shader::set_directional_shadow_map(GLenum texture_unit) const noexcept
     glUniform1i(uniform_directional_shadow_map_id, texture_unit);
 }
 
+void Shader::set_directional_shadow_comparison(GLenum texture_unit) const noexcept
+{
+    glUniform1i(uniform_directional_shadow_comparison_id, texture_unit);
+}
+
+void Shader::set_pcf_mode(GLint mode) const noexcept
+{
+    glUniform1i(uniform_pcf_mode_id, mode);
+}
+
 void Shader::set_directional_light_space_transform(const glm::mat4& directional_light_space_transform) const noexcept
 {
     glUniformMatrix4fv(uniform_directional_light_space_transform_id, 1, GL_FALSE, glm::value_ptr(directional_light_space_transform));
@@ -124,6 +134,8 @@ void Shader::create_program(std::string_view vertex_shader_code, std::string_vie
     uniform_num_spot_lights = glGetUniformLocation(program_id, "num_spot_lights");
     uniform_directional_light_space_transform_id = glGetUniformLocation(program_id, "directional_light_space_transform");
     uniform_directional_shadow_map_id = glGetUniformLocation(program_id, "directional_shadow_map");
+    uniform_directional_shadow_comparison_id = glGetUniformLocation(program_id, "directional_shadow_comparison");
+    uniform_pcf_mode_id = glGetUniformLocation(program_id, "pcf_mode");
     uniform_texture_id = glGetUniformLocation(program_id, "the_texture");
     
     for (size_t i = 0; i < MAX_POINT_LIGHTS; ++i)
@@ -61,4 +61,31 @@ void ShadowMap::read(GLenum texture_unit) noexcept
 {
     glActiveTexture(texture_unit);
     glBindTexture(GL_TEXTURE_2D, shadow_map_id);
+}
+
+void ShadowMap::read_comparison(GLenum texture_unit) noexcept
+{
+    read(texture_unit);
+    glBindSampler(texture_unit - GL_TEXTURE0, get_comparison_sampler());
+}
+
+GLuint ShadowMap::get_comparison_sampler() noexcept
+{
+    // Shared by every shadow map; the sampler overrides the texture's own parameters
+    static GLuint sampler_id{0};
+
+    if (!sampler_id)
+    {
+        glGenSamplers(1, &sampler_id);
+        glSamplerParameteri(sampler_id, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glSamplerParameteri(sampler_id, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        float border_color[] = {1.f, 1.f, 1.f, 1.f};
+        glSamplerParameterfv(sampler_id, GL_TEXTURE_BORDER_COLOR, border_color);
+    }
+
+    return sampler_id;
 }
\ No newline at end of file
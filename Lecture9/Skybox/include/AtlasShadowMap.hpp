@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+
+#include <ShadowAtlas.hpp>
+#include <ShadowMap.hpp>
+
+// Shadow map living in a tile of a ShadowAtlas. The tile may change from
+// frame to frame; moving it marks the map dirty.
+class AtlasShadowMap : public ShadowMap
+{
+public:
+    AtlasShadowMap(std::shared_ptr<ShadowAtlas> _atlas) noexcept;
+
+    ~AtlasShadowMap();
+
+    bool init(GLuint w, GLuint h) noexcept override;
+
+    void write() const noexcept override;
+
+    void read(GLenum texture_unit) noexcept override;
+
+    void set_tile(const ShadowAtlas::Tile& _tile) noexcept;
+
+    const ShadowAtlas::Tile& get_tile() const noexcept { return tile; }
+
+    bool has_tile() const noexcept { return tile.size > 0; }
+
+    glm::vec4 get_uv_scale_offset() const noexcept { return atlas->get_uv_scale_offset(tile); }
+
+private:
+    std::shared_ptr<ShadowAtlas> atlas{nullptr};
+    ShadowAtlas::Tile tile{};
+};
\ No newline at end of file
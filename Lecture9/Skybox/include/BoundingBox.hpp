@@ -0,0 +1,40 @@
+#pragma once
+
+#include <limits>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+class BoundingBox
+{
+public:
+    BoundingBox() = default;
+
+    BoundingBox(const glm::vec3& _min, const glm::vec3& _max) noexcept;
+
+    void expand(const glm::vec3& point) noexcept;
+
+    void expand(const BoundingBox& box) noexcept;
+
+    bool is_empty() const noexcept;
+
+    // Bounds of the eight transformed corners; meant for affine transforms
+    BoundingBox transform(const glm::mat4& matrix) const noexcept;
+
+    bool intersects(const BoundingBox& box) const noexcept;
+
+    bool intersects_sphere(const glm::vec3& center, GLfloat radius) const noexcept;
+
+    const glm::vec3& get_min() const noexcept { return min; }
+
+    const glm::vec3& get_max() const noexcept { return max; }
+
+    glm::vec3 get_center() const noexcept { return (min + max) * 0.5f; }
+
+    glm::vec3 get_extents() const noexcept { return (max - min) * 0.5f; }
+
+private:
+    glm::vec3 min{std::numeric_limits<GLfloat>::max()};
+    glm::vec3 max{std::numeric_limits<GLfloat>::lowest()};
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <algorithm>
+
+#include <ShadowMap.hpp>
+
+class CascadedShadowMap : public ShadowMap
+{
+public:
+    static constexpr size_t MAX_CASCADES{4};
+
+    CascadedShadowMap(GLuint _num_cascades) noexcept;
+
+    ~CascadedShadowMap();
+
+    bool init(GLuint w, GLuint h) noexcept override;
+
+    void read(GLenum texture_unit) noexcept override;
+
+    // Prefiltered EVSM moments of every cascade, created on first use
+    bool init_moments() noexcept;
+
+    void read_moments(GLenum texture_unit) const noexcept;
+
+    GLuint get_moments_id() const noexcept { return moments_id; }
+
+    GLuint get_num_cascades() const noexcept { return num_cascades; }
+
+private:
+    GLuint num_cascades{1};
+    GLuint moments_id{0};
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <BSlogger.hpp>
+
+#include <Shader.hpp>
+
+// Hi-Z pyramid of a frame's depth for occlusion culling: level 0 is half
+// the depth resolution and every texel holds the farthest depth of the
+// pixels under it, so a box nearer than the texels covering its screen
+// rectangle may be visible and one farther than all of them is hidden.
+// Built with depth_pyramid.comp, needs a GL 4.3 context.
+class DepthPyramid
+{
+public:
+    static constexpr GLuint WORK_GROUP_SIZE{8};
+
+    DepthPyramid(std::shared_ptr<Shader> _reduce_shader) noexcept;
+
+    DepthPyramid(const DepthPyramid&) = delete;
+
+    DepthPyramid& operator=(const DepthPyramid&) = delete;
+
+    ~DepthPyramid();
+
+    // Source depth of w x h pixels
+    bool init(GLuint w, GLuint h) noexcept;
+
+    // Copies the depth of the window and reduces it. The window must have a
+    // 24-bit depth and 8-bit stencil buffer, the GLFW default, to be copied.
+    void build_from_window() noexcept;
+
+    // Reduces a depth texture of the init size
+    void build(GLuint depth_texture_id) noexcept;
+
+    void read(GLenum texture_unit) const noexcept;
+
+    // Until the first build there is nothing to test against
+    void invalidate() noexcept { built = false; }
+
+    bool is_built() const noexcept { return built; }
+
+    glm::ivec2 get_depth_size() const noexcept { return glm::ivec2{GLint(width), GLint(height)}; }
+
+    GLint get_num_levels() const noexcept { return num_levels; }
+
+private:
+    std::shared_ptr<Shader> reduce_shader;
+
+    GLuint pyramid_id{0};
+    GLuint depth_copy_id{0};
+    GLuint copy_FBO_id{0};
+    GLuint width{0};
+    GLuint height{0};
+    GLint num_levels{0};
+    bool built{false};
+};
\ No newline at end of file
@@ -1,13 +1,19 @@
 #pragma once
 
+#include <vector>
+
+#include <CascadedShadowMap.hpp>
 #include <Light.hpp>
 
 class DirectionalLight: public Light
 {
 public:
+    // Blend between logarithmic (1) and uniform (0) cascade splits
+    static constexpr GLfloat SPLIT_LAMBDA{0.75f};
+
     DirectionalLight() = default;
 
-    DirectionalLight(GLuint shadow_width, GLuint shadow_height,
+    DirectionalLight(GLuint shadow_width, GLuint shadow_height, GLuint num_cascades,
                      GLfloat red, GLfloat green, GLfloat blue,
                      GLfloat _ambient_intensity, GLfloat _diffuse_intensity,
                      GLfloat x_dir, GLfloat y_dir, GLfloat z_dir) noexcept;
@@ -16,8 +22,20 @@ public:
 
     void use(GLuint color_id, GLuint ambient_intensity_id, GLuint diffuse_intensity_id, GLuint direction_id) const noexcept;
 
+    void update_cascades(const glm::mat4& view, GLfloat fov, GLfloat aspect, GLfloat near, GLfloat far) noexcept;
+
     glm::mat4 get_light_transform() const noexcept override;
 
+    bool shadow_volume_intersects(const BoundingBox& bounds) const noexcept override;
+
+    const std::vector<glm::mat4>& get_light_transforms() const noexcept { return light_transforms; }
+
+    const std::vector<GLfloat>& get_cascade_splits() const noexcept { return cascade_splits; }
+
 private:
+    glm::mat4 fit_cascade(const glm::mat4& view, GLfloat fov, GLfloat aspect, GLfloat near, GLfloat far) const noexcept;
+
     glm::vec3 direction{0.f, -1.f, 0.f};
-};
\ No newline at end of file
+    std::vector<glm::mat4> light_transforms{};
+    std::vector<GLfloat> cascade_splits{};
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <BSlogger.hpp>
+
+#include <BoundingBox.hpp>
+#include <GeometryPool.hpp>
+#include <Material.hpp>
+#include <Mesh.hpp>
+#include <Model.hpp>
+#include <Texture.hpp>
+
+class GpuCulling;
+
+// Decides how many instances of an object to draw given its world bounds and
+// its index in the DrawList (0 skips it)
+using DrawFilter = std::function<GLsizei(const BoundingBox&, size_t)>;
+
+// Every draw of the frame with its world matrix and bounds, built once
+// after the scene is updated and replayed by each pass, so an extra shadow
+// light only costs its culling and the submission.
+//
+// The matrices and materials go to the GPU once per frame as well, into a
+// texture buffer the shaders index by draw ID (see draw_data.glsl), so a
+// draw only sets that ID. The buffers rotate over a few frames so the CPU
+// never writes one the GPU may still be reading.
+//
+// Depth-only passes draw the position streams of the GeometryPool: one
+// glMultiDrawElementsIndirect per pass when the context has it (GL 4.3 or
+// ARB_multi_draw_indirect with ARB_base_instance), otherwise one
+// glMultiDrawElementsBaseVertex per item, since without base instances the
+// draw ID can only change between calls.
+class DrawList
+{
+public:
+    // Must match draw_data.glsl: model matrix, normal matrix, material and cube face mask
+    static constexpr size_t TEXELS_PER_DRAW{8};
+    static constexpr size_t NUM_BUFFERED_FRAMES{3};
+    static constexpr GLuint DRAW_ID_ATTRIBUTE{3};
+
+    // Above any instance count a pass uses, so every instance of an indirect command reads its base instance's ID
+    static constexpr GLuint DRAW_ID_DIVISOR{1024};
+
+    static constexpr size_t REPORT_INTERVAL{300};
+
+    // Flags of add
+    static constexpr unsigned OCCLUDER{1u << 0}; // Large enough to hide other items, rasterized by SoftwareOcclusion
+    static constexpr unsigned STATIC{1u << 1}; // Never moves, so PotentiallyVisibleSet can bake its visibility
+
+    enum class Mode
+    {
+        SHADED, // Full vertices and textures, one draw call per mesh
+        DEPTH, // Position streams, batched into multi-draw calls
+        DEPTH_UNBATCHED // Position streams, one call per mesh, for filters that set uniforms per item
+    };
+
+    // Layout fixed by GL for indirect draws
+    struct DrawCommand
+    {
+        GLuint count;
+        GLuint instance_count;
+        GLuint first_index;
+        GLint base_vertex;
+        GLuint base_instance;
+    };
+
+    struct Item
+    {
+        glm::mat4 model{1.f};
+        BoundingBox bounds{};
+
+        // Exactly one of mesh and scene_model is set
+        std::shared_ptr<Mesh> mesh{nullptr};
+        std::shared_ptr<Model> scene_model{nullptr};
+
+        // nullptr when the model binds its own textures
+        std::shared_ptr<Texture> texture{nullptr};
+        std::shared_ptr<Material> material{nullptr};
+
+        bool occluder{false};
+        bool is_static{false};
+    };
+
+    DrawList() = default;
+
+    DrawList(const DrawList&) = delete;
+
+    DrawList& operator=(const DrawList&) = delete;
+
+    ~DrawList();
+
+    bool init() noexcept;
+
+    void clear() noexcept { items.clear(); }
+
+    void add(std::shared_ptr<Mesh> mesh, std::shared_ptr<Texture> texture, std::shared_ptr<Material> material, const glm::mat4& model, unsigned flags = 0) noexcept;
+
+    void add(std::shared_ptr<Model> scene_model, std::shared_ptr<Material> material, const glm::mat4& model, unsigned flags = 0) noexcept;
+
+    // Writes the per-draw data of the current items into the next buffer of the ring.
+    // Face masks, one per item, tell layered cube map draws which faces the item covers.
+    void upload(const std::vector<GLuint>& face_masks = {}) noexcept;
+
+    // The buffer written by the last upload
+    void read(GLenum texture_unit) const noexcept;
+
+    // Draws the items the filter lets through; the pass name only keys the submission statistics
+    void render(std::string_view pass, const DrawFilter& filter = nullptr, Mode mode = Mode::SHADED) noexcept;
+
+    // Depth-only draw of the commands the last GPU cull wrote. Meshes without
+    // a position stream are not among them and go through the filter instead.
+    void render_culled(std::string_view pass, const GpuCulling& culling, const DrawFilter& filter) noexcept;
+
+    // One item on its own, for callers that wrap each draw (DEPTH draws like DEPTH_UNBATCHED). Returns the draw calls issued.
+    size_t draw_item(size_t index, Mode mode) noexcept;
+
+    // Submission statistics of a pass drawn through draw_item
+    void add_stats(std::string_view pass, size_t draw_calls, size_t num_commands, std::chrono::steady_clock::time_point cpu_start) noexcept;
+
+    // Logs the draw calls, commands and CPU time of every pass every REPORT_INTERVAL frames
+    void end_frame() noexcept;
+
+    bool has_multi_draw_indirect() const noexcept { return multi_draw_indirect; }
+
+    const std::vector<Item>& get_items() const noexcept { return items; }
+
+private:
+    struct PassStats
+    {
+        size_t draw_calls{0};
+        size_t commands{0};
+        double cpu_ms{0.0};
+    };
+
+    // Returns the draw calls issued
+    size_t submit(const std::vector<DrawCommand>& draw_commands) noexcept;
+
+    struct TextureBuffer
+    {
+        GLuint buffer_id{0};
+        GLuint texture_id{0};
+        size_t capacity{0};
+    };
+
+    std::vector<Item> items;
+    std::vector<glm::vec4> draw_data;
+    std::array<TextureBuffer, NUM_BUFFERED_FRAMES> buffers{};
+    size_t current_buffer{0};
+
+    std::shared_ptr<GeometryPool> pool{nullptr};
+    bool multi_draw_indirect{false};
+    GLuint indirect_buffer_id{0};
+    std::vector<DrawCommand> commands;
+    std::vector<GLsizei> counts;
+    std::vector<const void*> offsets;
+    std::vector<GLint> base_vertices;
+
+    std::map<std::string, PassStats, std::less<>> pass_stats;
+    size_t num_frames{0};
+};
\ No newline at end of file
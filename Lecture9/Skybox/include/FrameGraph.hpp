@@ -0,0 +1,172 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <BSlogger.hpp>
+
+// The passes of a frame declared up front with the resources they read and
+// write, then culled, allocated and run in the order they were added.
+//
+// A pass survives when it has side effects (drawing to the window, filling
+// something kept across frames) or when a surviving pass reads what it
+// writes, so passes can be declared unconditionally and the graph drops the
+// ones nothing uses this frame.
+//
+// Transient textures only exist between the first and the last surviving pass
+// touching them. They come from a pool kept across frames, and a target whose
+// lifetime is over hands its texture to the next target of the same size and
+// format, so render targets stop adding up as passes are added. The
+// framebuffers combining them are cached, and one is only bound when the
+// targets change from the previous pass. Resources owned elsewhere, like the
+// shadow maps that are cached across frames, are imported instead.
+class FrameGraph
+{
+public:
+    using Resource = size_t;
+
+    // For imported resources the passes writing them bind targets of their own
+    static constexpr GLint OWN_FRAMEBUFFER{-1};
+
+    // Frames a pooled texture may stay unused before it is deleted
+    static constexpr size_t POOL_FRAMES{120};
+
+    static constexpr size_t REPORT_INTERVAL{300};
+
+    struct TextureDesc
+    {
+        GLuint width{0};
+        GLuint height{0};
+        GLenum internal_format{GL_RGBA8};
+
+        bool operator==(const TextureDesc& other) const noexcept
+        {
+            return width == other.width && height == other.height && internal_format == other.internal_format;
+        }
+    };
+
+    // Handed to the setup of a pass to declare its resources
+    class Builder
+    {
+    public:
+        // A transient texture the pass renders to; depth formats become the depth attachment
+        Resource create(std::string_view name, const TextureDesc& desc) noexcept;
+
+        Resource read(Resource resource) noexcept;
+
+        Resource write(Resource resource) noexcept;
+
+        // Keeps the pass even when nothing in the graph reads what it writes
+        void side_effects() noexcept;
+
+    private:
+        friend class FrameGraph;
+
+        Builder(FrameGraph& _graph, size_t _pass) noexcept : graph{_graph}, pass{_pass} {}
+
+        FrameGraph& graph;
+        size_t pass;
+    };
+
+    using Setup = std::function<void(Builder&)>;
+    using Execute = std::function<void(FrameGraph&)>;
+
+    FrameGraph() = default;
+
+    FrameGraph(const FrameGraph&) = delete;
+
+    FrameGraph& operator=(const FrameGraph&) = delete;
+
+    ~FrameGraph();
+
+    // A persistent resource; framebuffer is bound for the passes writing it unless OWN_FRAMEBUFFER
+    Resource import_resource(std::string_view name, GLint framebuffer = OWN_FRAMEBUFFER) noexcept;
+
+    void add_pass(std::string_view name, const Setup& setup, Execute execute) noexcept;
+
+    // Culls the passes and places every transient texture in the pool for its lifetime
+    void compile() noexcept;
+
+    // Runs the surviving passes, then clears the graph for the next frame
+    void execute() noexcept;
+
+    // The texture of a transient resource, valid during the passes that use it
+    GLuint get_texture(Resource resource) const noexcept { return resources[resource].texture_id; }
+
+    // Blits a transient depth target into framebuffer, which is left bound. The
+    // formats must match, D24S8 for the window's depth.
+    void copy_depth(Resource source, GLint framebuffer) noexcept;
+
+private:
+    struct ResourceNode
+    {
+        std::string name;
+        TextureDesc desc{};
+        bool imported{false};
+        GLint framebuffer{OWN_FRAMEBUFFER};
+        std::vector<size_t> writers;
+        size_t ref_count{0};
+        size_t first_pass{0};
+        size_t last_pass{0};
+        bool used{false};
+        GLuint texture_id{0};
+    };
+
+    struct PassNode
+    {
+        std::string name;
+        Execute execute;
+        std::vector<Resource> reads;
+        std::vector<Resource> writes;
+        bool side_effects{false};
+        size_t ref_count{0};
+        bool culled{false};
+    };
+
+    struct PooledTexture
+    {
+        TextureDesc desc{};
+        GLuint texture_id{0};
+        bool in_use{false};
+        size_t last_frame{0};
+    };
+
+    void cull() noexcept;
+
+    GLuint acquire(const TextureDesc& desc) noexcept;
+
+    void release(GLuint texture_id) noexcept;
+
+    // Deletes the textures unused for POOL_FRAMES frames and the framebuffers holding them
+    void trim_pool() noexcept;
+
+    // The transient targets of the pass, or the framebuffer of an imported resource it writes
+    void bind_targets(const PassNode& pass) noexcept;
+
+    GLuint get_framebuffer(const std::vector<GLuint>& color_ids, GLuint depth_id, bool depth_stencil) noexcept;
+
+    static bool is_depth_format(GLenum internal_format) noexcept;
+
+    static size_t get_bytes_per_texel(GLenum internal_format) noexcept;
+
+    std::vector<ResourceNode> resources;
+    std::vector<PassNode> passes;
+
+    std::vector<PooledTexture> pool;
+
+    // Keyed by the color attachments followed by the depth attachment
+    std::map<std::vector<GLuint>, GLuint> framebuffers;
+    GLint bound_framebuffer{OWN_FRAMEBUFFER};
+
+    size_t frame{0};
+    size_t num_frames{0};
+    size_t num_passes{0};
+    size_t num_culled{0};
+    size_t num_transients{0};
+    size_t num_bindings{0};
+};
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+#include <BoundingBox.hpp>
+
+class Frustum
+{
+public:
+    Frustum() = default;
+
+    Frustum(const glm::mat4& view_projection) noexcept;
+
+    bool intersects(const BoundingBox& bounds) const noexcept;
+
+    const std::array<glm::vec4, 6>& get_planes() const noexcept { return planes; }
+
+private:
+    // Plane equations (normal, distance) pointing inside the frustum
+    std::array<glm::vec4, 6> planes{};
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <FrameGraph.hpp>
+
+// Render targets of the deferred path, packed as in gbuffer.glsl:
+// albedo and specular intensity in RGBA8, octahedral normal and
+// shininess in RGB10_A2, and the depth the positions are rebuilt from.
+// They are transient targets of the frame graph, alive from the geometry
+// pass to the last pass reading them.
+struct GBuffer
+{
+    FrameGraph::Resource albedo_specular{0};
+    FrameGraph::Resource normal_shininess{0};
+    FrameGraph::Resource depth{0};
+
+    // The targets of the geometry pass being set up, which clears them
+    static GBuffer create(FrameGraph::Builder& builder, GLuint w, GLuint h) noexcept;
+
+    void declare_reads(FrameGraph::Builder& builder) const noexcept;
+
+    void read(const FrameGraph& graph, GLenum albedo_specular_texture_unit, GLenum normal_shininess_texture_unit, GLenum depth_texture_unit) const noexcept;
+};
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <BSlogger.hpp>
+
+// Single vertex and index buffer holding the position streams of every
+// mesh, behind one VAO. Any number of meshes can then go out in one
+// multi-draw call, each addressed by its first index and base vertex.
+class GeometryPool
+{
+public:
+    static constexpr size_t INITIAL_VERTICES{1 << 16};
+    static constexpr size_t INITIAL_INDICES{1 << 18};
+
+    // Where a mesh lives in the pool
+    struct Range
+    {
+        GLuint first_index{0};
+        GLuint index_count{0};
+        GLint base_vertex{0};
+    };
+
+    // Shared storage, created on first use and released with the last mesh
+    static std::shared_ptr<GeometryPool> get_instance() noexcept;
+
+    GeometryPool() noexcept;
+
+    GeometryPool(const GeometryPool&) = delete;
+
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    ~GeometryPool();
+
+    // xyz positions and indices relative to them
+    Range add(const std::vector<GLfloat>& positions, const std::vector<unsigned int>& indices) noexcept;
+
+    // Draw ID left to the current vertex attribute value
+    void bind() const noexcept;
+
+    // Draw ID from the instanced buffer of set_draw_ids, for indirect draws
+    void bind_indirect() const noexcept;
+
+    // Feeds the attribute of the indirect VAO from a 0, 1, 2... buffer
+    // stepping once every divisor instances, so an indirect command's base
+    // instance selects its draw ID however many instances it has.
+    void set_draw_ids(GLuint attribute, GLuint divisor, size_t count) noexcept;
+
+private:
+    // Moves the contents to a larger buffer, the VAO is pointed at it afterwards
+    static void grow(GLuint& buffer_id, size_t used, size_t capacity) noexcept;
+
+    void attach(GLuint vertex_array_id) noexcept;
+
+    static std::weak_ptr<GeometryPool> instance;
+
+    GLuint VAO_id{0};
+    GLuint indirect_VAO_id{0};
+    GLuint VBO_id{0};
+    GLuint IBO_id{0};
+    GLuint draw_id_buffer_id{0};
+    size_t num_vertices{0};
+    size_t vertex_capacity{INITIAL_VERTICES};
+    size_t num_indices{0};
+    size_t index_capacity{INITIAL_INDICES};
+    size_t num_draw_ids{0};
+};
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <BSlogger.hpp>
+
+#include <DepthPyramid.hpp>
+#include <DrawList.hpp>
+#include <Frustum.hpp>
+#include <GeometryPool.hpp>
+#include <Shader.hpp>
+
+// Camera visibility decided on the GPU. cull.comp tests the world bounds
+// of every position stream in the DrawList against the frustum and a
+// DepthPyramid of the previous frame, and writes the indirect commands of
+// the survivors packed at the front of a buffer with an atomic counter, so
+// the CPU never looks at per-object visibility. The count goes straight to
+// glMultiDrawElementsIndirectCount when the context has it (GL 4.6 or
+// ARB_indirect_parameters); otherwise the buffer is cleared before each
+// cull and every slot is drawn, the rejected ones as empty commands.
+class GpuCulling
+{
+public:
+    // Must match cull.comp
+    static constexpr GLuint WORK_GROUP_SIZE{64};
+    static constexpr GLuint OBJECTS_BINDING{0};
+    static constexpr GLuint COMMANDS_BINDING{1};
+    static constexpr GLuint DRAW_COUNT_BINDING{2};
+
+    // std430 layout of cull.comp: world bounds and the command to emit
+    struct Object
+    {
+        glm::vec4 bounds_min;
+        glm::vec4 bounds_max;
+        GLuint count;
+        GLuint first_index;
+        GLint base_vertex;
+        GLuint draw_id;
+    };
+
+    // Compute shaders, storage buffers and indirect draws with base instances are all core in 4.3
+    static bool is_supported() noexcept { return GLEW_VERSION_4_3; }
+
+    GpuCulling(std::shared_ptr<Shader> _cull_shader) noexcept;
+
+    GpuCulling(const GpuCulling&) = delete;
+
+    GpuCulling& operator=(const GpuCulling&) = delete;
+
+    ~GpuCulling();
+
+    bool init() noexcept;
+
+    // Takes the objects of the draw list the filter lets through, once a frame after it is built
+    void update(const DrawList& draw_list, const DrawFilter& filter = nullptr) noexcept;
+
+    // Frustum test only while the pyramid has not been built
+    void cull(const Frustum& frustum, const DepthPyramid& pyramid, const glm::mat4& pyramid_view_projection, GLuint pyramid_texture_unit) noexcept;
+
+    // One indirect draw of what the last cull let through
+    void draw() const noexcept;
+
+    size_t get_num_objects() const noexcept { return objects.size(); }
+
+private:
+    std::shared_ptr<Shader> cull_shader;
+    std::shared_ptr<GeometryPool> pool{nullptr};
+    bool indirect_count{false};
+
+    GLuint objects_buffer_id{0};
+    GLuint commands_buffer_id{0};
+    GLuint draw_count_buffer_id{0};
+    size_t command_capacity{0};
+    std::vector<Object> objects;
+};
\ No newline at end of file
@@ -1,11 +1,13 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <BoundingBox.hpp>
 #include <ShadowMap.hpp>
 
 class Light
@@ -13,7 +15,7 @@ class Light
 public:
     Light() = default;
 
-    Light(GLuint shadow_width, GLuint shadow_height, GLfloat red, GLfloat green, GLfloat blue, GLfloat _ambient_intensity, GLfloat _diffuse_intensity) noexcept;
+    Light(GLfloat red, GLfloat green, GLfloat blue, GLfloat _ambient_intensity, GLfloat _diffuse_intensity) noexcept;
 
     virtual ~Light();
 
@@ -21,9 +23,24 @@ public:
 
     virtual glm::mat4 get_light_transform() const noexcept = 0;
 
+    // True when a caster inside the bounds can change this light's shadow map
+    virtual bool shadow_volume_intersects(const BoundingBox& bounds) const noexcept = 0;
+
+    void invalidate_shadow_map(const std::vector<BoundingBox>& changed_bounds) noexcept;
+
     std::shared_ptr<ShadowMap> get_shadow_map() const noexcept { return shadow_map; }
 
+    const glm::vec3& get_color() const noexcept { return color; }
+
+    GLfloat get_ambient_intensity() const noexcept { return ambient_intensity; }
+
+    GLfloat get_diffuse_intensity() const noexcept { return diffuse_intensity; }
+
+    // Changes whenever a parameter does, so cached derived values can be checked cheaply
+    GLuint get_version() const noexcept { return version; }
+
 protected:
+    GLuint version{0};
     glm::vec3 color{1.f, 1.f, 1.f};
     GLfloat ambient_intensity{1.f};
     GLfloat diffuse_intensity{0.f};
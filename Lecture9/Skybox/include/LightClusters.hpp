@@ -0,0 +1,107 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <BSlogger.hpp>
+
+#include <LightTable.hpp>
+#include <WorkerPool.hpp>
+
+// Clustered forward lighting. The view frustum is cut into a grid of
+// screen tiles and exponential depth slices, every light is binned into
+// the clusters its bounding sphere touches and the lighting shader only
+// walks the list of its own cluster. Binning runs on the CPU every frame,
+// one depth slice per task spread over the shared worker pool, testing four
+// lights at a time with SSE when SKYBOX_SIMD is defined.
+//
+// Three texture buffers hold the result: the packed lights, an
+// (offset, count) pair per cluster and the light indices of every cluster.
+class LightClusters
+{
+public:
+    static constexpr GLuint CLUSTERS_X{16};
+    static constexpr GLuint CLUSTERS_Y{9};
+    static constexpr GLuint CLUSTERS_Z{24};
+    static constexpr GLuint NUM_CLUSTERS{CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z};
+
+    // Below this many lights waking the workers costs more than the binning itself
+    static constexpr size_t PARALLEL_THRESHOLD{32};
+
+    LightClusters() noexcept;
+
+    LightClusters(const LightClusters&) = delete;
+
+    LightClusters& operator=(const LightClusters&) = delete;
+
+    ~LightClusters();
+
+    bool init() noexcept;
+
+    // Rebuilds the view space bounds of every cluster
+    void set_projection(GLfloat fov, GLfloat aspect, GLfloat near, GLfloat far) noexcept;
+
+    // Bins the table's lights for this view and uploads the three buffers
+    void update(const glm::mat4& view, const LightTable& lights) noexcept;
+
+    void read(GLenum lights_texture_unit, GLenum table_texture_unit, GLenum indices_texture_unit) const noexcept;
+
+    // Lights before this index are point lights, the rest spot lights
+    GLuint get_num_point_lights() const noexcept { return num_point_lights; }
+
+    // Slice of a view depth: scale * log(depth) + bias
+    glm::vec2 get_depth_slicing() const noexcept;
+
+    size_t get_num_indices() const noexcept { return light_indices.size(); }
+
+private:
+    struct TextureBuffer
+    {
+        GLuint buffer_id{0};
+        GLuint texture_id{0};
+        size_t capacity{0};
+    };
+
+    // Lights overlapping one depth slice in structure of arrays form,
+    // padded to a multiple of four, and what the slice's clusters got
+    struct Slice
+    {
+        std::vector<GLfloat> x;
+        std::vector<GLfloat> y;
+        std::vector<GLfloat> z;
+        std::vector<GLfloat> radius_squared;
+        std::vector<GLuint> ids;
+        std::vector<GLuint> counts;
+        std::vector<GLuint> indices;
+    };
+
+    bool create_buffer(TextureBuffer& buffer, GLenum internal_format) noexcept;
+
+    void upload(TextureBuffer& buffer, GLenum internal_format, const void* data, size_t size) noexcept;
+
+    void bin_slice(GLuint slice_index) noexcept;
+
+    GLfloat near_plane{0.1f};
+    GLfloat far_plane{100.f};
+    GLuint num_point_lights{0};
+
+    // View space bounds of every cluster, x fastest then y then z
+    std::vector<glm::vec3> cluster_min;
+    std::vector<glm::vec3> cluster_max;
+
+    // xyz: view space center, w: radius
+    std::vector<glm::vec4> spheres;
+    std::vector<Slice> slices;
+
+    std::vector<GLuint> cluster_table;
+    std::vector<GLuint> light_indices;
+
+    TextureBuffer lights_buffer{};
+    TextureBuffer table_buffer{};
+    TextureBuffer indices_buffer{};
+
+    std::shared_ptr<WorkerPool> workers;
+};
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <OmnidirectionalShadowMap.hpp>
+#include <PointLight.hpp>
+#include <SpotLight.hpp>
+
+// Everything derived from the point and spot lights, kept in contiguous
+// arrays indexed by light: point lights first, then spot lights. An entry is
+// only recomputed when its light reports a new version or changes shadow
+// slot, so a still scene does no light math at all from frame to frame.
+// Culling reads the bounding spheres and ranges, the shadow passes the
+// view projection matrices and the cluster upload the packed texels as is.
+class LightTable
+{
+public:
+    // Must match the light layout in lighting.glsl
+    static constexpr size_t TEXELS_PER_LIGHT{4};
+
+    using FaceTransforms = std::array<glm::mat4, OmnidirectionalShadowMap::NUM_FACES>;
+
+    LightTable() = default;
+
+    LightTable(const LightTable&) = delete;
+
+    LightTable& operator=(const LightTable&) = delete;
+
+    // Only the first max_shadowed lights of each kind keep their shadow map
+    void update(const std::vector<std::shared_ptr<PointLight>>& point_lights,
+                const std::vector<std::shared_ptr<SpotLight>>& spot_lights,
+                size_t max_shadowed_point_lights, size_t max_shadowed_spot_lights) noexcept;
+
+    size_t get_num_lights() const noexcept { return sources.size(); }
+
+    size_t get_num_point_lights() const noexcept { return num_point_lights; }
+
+    // Index in the table of the given spot light
+    size_t get_spot_light_index(size_t spot_light) const noexcept { return num_point_lights + spot_light; }
+
+    // Index in the table of a light, -1 if the table does not hold it
+    GLint find(const PointLight* light) const noexcept;
+
+    GLfloat get_range(size_t light) const noexcept { return ranges[light]; }
+
+    // World space, xyz: center, w: radius
+    const std::vector<glm::vec4>& get_bounding_spheres() const noexcept { return spheres; }
+
+    const FaceTransforms& get_point_light_transforms(size_t point_light) const noexcept { return point_transforms[point_light]; }
+
+    const glm::mat4& get_spot_light_transform(size_t spot_light) const noexcept { return spot_transforms[spot_light]; }
+
+    // TEXELS_PER_LIGHT RGBA32F texels per light, ready for the cluster buffer
+    const std::vector<glm::vec4>& get_texels() const noexcept { return texels; }
+
+    // Entries recomputed by the last update
+    size_t get_num_updated() const noexcept { return num_updated; }
+
+private:
+    // True when the entry had to be recomputed
+    bool update_entry(size_t index, const PointLight& light, GLint shadow_index) noexcept;
+
+    size_t num_point_lights{0};
+    size_t num_updated{0};
+
+    // What every entry was computed from
+    std::vector<const PointLight*> sources;
+    std::vector<GLuint> versions;
+    std::vector<GLint> shadow_indices;
+    std::unordered_map<const PointLight*, size_t> indices;
+
+    std::vector<GLfloat> ranges;
+    std::vector<glm::vec4> spheres;
+    std::vector<glm::vec3> directions;
+    std::vector<GLfloat> cos_edges;
+    std::vector<FaceTransforms> point_transforms;
+    std::vector<glm::mat4> spot_transforms;
+    std::vector<glm::vec4> texels;
+};
\ No newline at end of file
@@ -13,6 +13,10 @@ public:
 
     void use(GLuint specular_intensity_id, GLuint specular_shininess_id) const noexcept;
 
+    GLfloat get_specular_intensity() const noexcept { return specular_intensity; }
+
+    GLfloat get_shininess() const noexcept { return shininess; }
+
 private:
     GLfloat specular_intensity{0.f};
     GLfloat shininess{0.f};
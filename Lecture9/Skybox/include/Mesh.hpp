@@ -4,13 +4,24 @@
 #include <vector>
 
 #include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <BoundingBox.hpp>
+#include <GeometryPool.hpp>
 
 class Mesh
 {
 public:
+    static constexpr size_t VERTEX_LENGTH{8};
+
+    // Triangles kept for CPU occlusion culling, the largest ones of the mesh
+    static constexpr size_t MAX_OCCLUDER_TRIANGLES{256};
+
     Mesh() = default;
 
-    static std::shared_ptr<Mesh> create(const std::vector<GLfloat>& vertices, std::vector<unsigned int>& indices) noexcept;
+    // With position_stream the mesh also keeps the positions alone, welded across UV and
+    // normal seams, in the shared GeometryPool
+    static std::shared_ptr<Mesh> create(const std::vector<GLfloat>& vertices, std::vector<unsigned int>& indices, bool position_stream = false) noexcept;
 
     Mesh(const Mesh& mesh) = delete;
 
@@ -22,13 +33,34 @@ public:
 
     Mesh& operator = (Mesh&& mesh) = delete;
 
-    void render() const noexcept;
-    
+    void render(GLsizei instance_count = 1) const noexcept;
+
+    // For depth-only passes, falls back to the full vertices without a position stream
+    void render_positions(GLsizei instance_count = 1) const noexcept;
+
+    bool has_position_stream() const noexcept { return position_pool != nullptr; }
+
+    const GeometryPool::Range& get_position_range() const noexcept { return position_range; }
+
+    const BoundingBox& get_bounds() const noexcept { return bounds; }
+
+    // Three positions per triangle, only with a position stream. A subset of
+    // the surface hides no more than the whole mesh, so it stays conservative.
+    const std::vector<glm::vec3>& get_occluder_triangles() const noexcept { return occluder_triangles; }
+
 private:
+    void create_position_stream(const std::vector<GLfloat>& vertices, const std::vector<unsigned int>& indices) noexcept;
+
+    void create_occluder(const std::vector<GLfloat>& positions, const std::vector<unsigned int>& indices) noexcept;
+
     void clear() noexcept;
 
     GLuint VAO_id{0};
     GLuint VBO_id{0};
     GLuint IBO_id{0};
     GLsizei index_count{0};
+    std::shared_ptr<GeometryPool> position_pool{nullptr};
+    GeometryPool::Range position_range{};
+    BoundingBox bounds{};
+    std::vector<glm::vec3> occluder_triangles;
 };
\ No newline at end of file
@@ -23,7 +23,14 @@ public:
 
     void load(std::string_view model_name) noexcept;
 
-    void render() const noexcept;
+    void render(GLsizei instance_count = 1) const noexcept;
+
+    // Position streams only and no textures, for depth-only passes
+    void render_positions(GLsizei instance_count = 1) const noexcept;
+
+    BoundingBox get_bounds() const noexcept;
+
+    const std::vector<std::shared_ptr<Mesh>>& get_meshes() const noexcept { return mesh_list; }
 
 private:
     void load_node(aiNode* node, const aiScene* scene) noexcept;
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <BSlogger.hpp>
+
+#include <DrawList.hpp>
+#include <Shader.hpp>
+
+// Hardware occlusion queries over the DrawList items, in the manner of
+// coherent hierarchical culling with a flat hierarchy. The pass that lays
+// down the camera depth first draws the items visible last frame, each
+// inside a query that tells whether it still is. Every other item in the
+// frustum is then tested with a query on its bounding box and drawn under
+// glBeginConditionalRender on that query, so the GPU skips it when the box
+// is hidden without the CPU waiting for the answer.
+//
+// The CPU reads the results a frame or more late, only when they are
+// available, and the answer decides how the item is handled next frame.
+// A later pass over the same depth can draw each item under the query it
+// got this frame.
+class OcclusionCulling
+{
+public:
+    static constexpr size_t NUM_BUFFERED_FRAMES{3};
+    static constexpr size_t REPORT_INTERVAL{300};
+
+    // Boxes reaching this close to the eye may be cut by the near plane, they are never box-tested
+    OcclusionCulling(std::shared_ptr<Shader> _box_shader, GLfloat _near_margin) noexcept;
+
+    OcclusionCulling(const OcclusionCulling&) = delete;
+
+    OcclusionCulling& operator=(const OcclusionCulling&) = delete;
+
+    ~OcclusionCulling();
+
+    bool init() noexcept;
+
+    // Takes the results that arrived, once a frame after the draw list is built
+    void begin_frame(const DrawList& draw_list) noexcept;
+
+    // The pass that fills the depth. The pass shader is in use with its uniforms set and is used again after the box queries.
+    void render(std::string_view pass, DrawList& draw_list, DrawList::Mode mode, const DrawFilter& filter,
+                const Shader& pass_shader, const glm::mat4& projection, const glm::mat4& view, const glm::vec3& eye) noexcept;
+
+    // A later pass over the depth of render, each item drawn only if its query of this frame passed
+    void render_conditional(std::string_view pass, DrawList& draw_list, DrawList::Mode mode) noexcept;
+
+    // Logs how many tested items the queries kept out every REPORT_INTERVAL frames
+    void end_frame() noexcept;
+
+private:
+    struct Object
+    {
+        std::array<GLuint, NUM_BUFFERED_FRAMES> queries{};
+        std::array<bool, NUM_BUFFERED_FRAMES> pending{};
+        bool visible{true};
+        bool queried{false}; // In this frame's slot
+    };
+
+    void resize(size_t num_objects) noexcept;
+
+    void read_result(Object& object, size_t slot, bool wait) noexcept;
+
+    std::shared_ptr<Shader> box_shader;
+    GLfloat near_margin{0.f};
+    GLenum query_target{GL_ANY_SAMPLES_PASSED};
+    GLuint box_VAO_id{0};
+
+    std::vector<Object> objects;
+    std::vector<size_t> hidden;
+    size_t slot{0};
+
+    size_t num_frames{0};
+    size_t num_tested{0};
+    size_t num_hidden{0};
+};
\ No newline at end of file
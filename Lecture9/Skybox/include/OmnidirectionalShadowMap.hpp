@@ -1,17 +1,48 @@
 #pragma once
 
 #include <ShadowMap.hpp>
+#include <OmnidirectionalShadowMapArray.hpp>
 
 class OmnidirectionalShadowMap : public ShadowMap
 {
 public:
-    static constexpr size_t NUM_FACES{6};
+    static constexpr size_t NUM_FACES{OmnidirectionalShadowMapArray::NUM_FACES};
+
+    // How the six faces are rendered
+    enum class Mode
+    {
+        GEOMETRY_SHADER, // Every triangle is replicated to all faces
+        PER_FACE,        // One pass per face with only the objects inside it
+        VERTEX_LAYER     // One instance per overlapped face, batched, gl_Layer set in the vertex shader
+    };
 
     OmnidirectionalShadowMap() noexcept;
 
     ~OmnidirectionalShadowMap();
 
     bool init(GLuint w, GLuint h) noexcept override;
+
+    // Binds the whole array, gl_Layer must be offset by get_layer_offset()
+    void write() const noexcept override;
+
+    void write_face(size_t face) const noexcept;
+
+    // Clears only the six layers of this cube
+    void clear() const noexcept;
     
     void read(GLenum texture_unit) noexcept override;
+
+    bool init_moments() noexcept { return storage->init_moments(); }
+
+    void read_moments(GLenum texture_unit) const noexcept { storage->read_moments(texture_unit); }
+
+    std::shared_ptr<OmnidirectionalShadowMapArray> get_storage() const noexcept { return storage; }
+
+    GLint get_cube() const noexcept { return cube; }
+
+    GLint get_layer_offset() const noexcept { return cube * NUM_FACES; }
+
+private:
+    std::shared_ptr<OmnidirectionalShadowMapArray> storage{nullptr};
+    GLint cube{-1};
 };
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <BSlogger.hpp>
+
+class OmnidirectionalShadowMap;
+
+// Single cube map array holding the shadow cubes of every point light.
+// Each light owns one cube (six consecutive layers) and all of them are
+// written through the same framebuffers and sampled from one texture unit.
+class OmnidirectionalShadowMapArray
+{
+public:
+    static constexpr size_t NUM_FACES{6};
+    static constexpr size_t INITIAL_CAPACITY{4};
+
+    // Shared storage, created on first use and released with the last cube
+    static std::shared_ptr<OmnidirectionalShadowMapArray> get_instance(GLuint w, GLuint h) noexcept;
+
+    OmnidirectionalShadowMapArray(GLuint w, GLuint h) noexcept;
+
+    OmnidirectionalShadowMapArray(const OmnidirectionalShadowMapArray&) = delete;
+
+    OmnidirectionalShadowMapArray& operator=(const OmnidirectionalShadowMapArray&) = delete;
+
+    ~OmnidirectionalShadowMapArray();
+
+    // Returns the cube index given to the shadow map, or -1 on failure
+    GLint allocate(OmnidirectionalShadowMap* shadow_map) noexcept;
+
+    void release(GLint cube) noexcept;
+
+    // Binds every layer at once; the shaders offset gl_Layer by the cube
+    void write() const noexcept;
+
+    // Binds a single face of a single cube
+    void write_face(GLint cube, size_t face) const noexcept;
+
+    void read(GLenum texture_unit) const noexcept;
+
+    // Prefiltered ESM copy of every cube, created on first use and kept at the same capacity
+    bool init_moments() noexcept;
+
+    void read_moments(GLenum texture_unit) const noexcept;
+
+    GLuint get_shadow_map_id() const noexcept { return shadow_map_id; }
+
+    GLuint get_moments_id() const noexcept { return moments_id; }
+
+    GLuint get_width() const noexcept { return width; }
+
+    GLuint get_height() const noexcept { return height; }
+
+private:
+    bool resize(size_t capacity) noexcept;
+
+    void create_moments() noexcept;
+
+    static std::weak_ptr<OmnidirectionalShadowMapArray> instance;
+
+    GLuint FBO_id{0};
+    GLuint face_FBO_id{0};
+    GLuint shadow_map_id{0};
+    GLuint moments_id{0};
+    GLuint width{0};
+    GLuint height{0};
+    std::vector<OmnidirectionalShadowMap*> cubes;
+};
\ No newline at end of file
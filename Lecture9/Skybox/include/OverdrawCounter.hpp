@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+
+#include <GL/glew.h>
+
+#include <BSlogger.hpp>
+
+// Counts the fragments that pass the depth test during a pass and relates
+// them to the pixels on screen. Read back like PassTimer, a few frames late,
+// so it never stalls the pipeline.
+class OverdrawCounter
+{
+public:
+    static constexpr size_t NUM_BUFFERED_FRAMES{3};
+    static constexpr size_t REPORT_INTERVAL{300};
+
+    OverdrawCounter(std::string_view _name) noexcept;
+
+    OverdrawCounter(const OverdrawCounter& counter) = delete;
+
+    OverdrawCounter(OverdrawCounter&& counter) = delete;
+
+    ~OverdrawCounter();
+
+    OverdrawCounter& operator = (const OverdrawCounter& counter) = delete;
+
+    OverdrawCounter& operator = (OverdrawCounter&& counter) = delete;
+
+    void begin() noexcept;
+
+    void end(GLuint width, GLuint height) noexcept;
+
+    // Shaded fragments per pixel, smoothed over the last frames; 0 until the first result arrives
+    double get_overdraw() const noexcept { return overdraw; }
+
+private:
+    void collect(size_t frame) noexcept;
+
+    void report() noexcept;
+
+    std::string name;
+    std::array<GLuint, NUM_BUFFERED_FRAMES> query_ids{};
+    std::array<bool, NUM_BUFFERED_FRAMES> pending{};
+    std::array<GLuint, NUM_BUFFERED_FRAMES> num_pixels{};
+    size_t current_frame{0};
+    size_t num_samples{0};
+    bool has_result{false};
+    double overdraw{0.0};
+    double total_overdraw{0.0};
+    double max_overdraw{0.0};
+};
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include <GL/glew.h>
+
+#include <BSlogger.hpp>
+
+class PassTimer
+{
+public:
+    // Queries are read back this many frames later so the CPU never waits for the GPU
+    static constexpr size_t NUM_BUFFERED_FRAMES{3};
+    static constexpr size_t REPORT_INTERVAL{300};
+
+    PassTimer(std::string_view _name) noexcept;
+
+    PassTimer(const PassTimer& timer) = delete;
+
+    PassTimer(PassTimer&& timer) = delete;
+
+    ~PassTimer();
+
+    PassTimer& operator = (const PassTimer& timer) = delete;
+
+    PassTimer& operator = (PassTimer&& timer) = delete;
+
+    void begin() noexcept;
+
+    void end() noexcept;
+
+    // Drops the accumulated samples, e.g. after switching the technique being timed
+    void reset(std::string_view _name) noexcept;
+
+private:
+    void collect(size_t frame) noexcept;
+
+    void report() noexcept;
+
+    std::string name;
+    std::array<GLuint, NUM_BUFFERED_FRAMES * 2> query_ids{};
+    std::array<bool, NUM_BUFFERED_FRAMES> pending{};
+    std::array<double, NUM_BUFFERED_FRAMES> cpu_ms{};
+    std::chrono::steady_clock::time_point cpu_start{};
+    size_t current_frame{0};
+    size_t num_samples{0};
+    double total_gpu_ms{0.0};
+    double total_cpu_ms{0.0};
+};
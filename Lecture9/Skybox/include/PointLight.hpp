@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include <Light.hpp>
 #include <OmnidirectionalShadowMap.hpp>
 
@@ -19,16 +21,42 @@ public:
 
     glm::mat4 get_light_transform() const noexcept { return glm::mat4{}; }
 
-    std::vector<glm::mat4> get_light_transforms() const noexcept;
+    bool shadow_volume_intersects(const BoundingBox& bounds) const noexcept override;
+
+    // View projection of every cube face; LightTable keeps them between changes
+    std::array<glm::mat4, OmnidirectionalShadowMap::NUM_FACES> get_light_transforms() const noexcept;
 
     const glm::vec3& get_position() const noexcept { return position; }
 
+    GLfloat get_near_plane() const noexcept { return near_plane; }
+
     GLfloat get_far_plane() const noexcept { return far_plane; }
 
+    // Distance where the attenuated light stops being noticeable, at most the far plane
+    GLfloat get_range() const noexcept;
+
+    // World space sphere (xyz: center, w: radius) holding everything the light reaches
+    virtual glm::vec4 get_bounding_sphere() const noexcept;
+
+    // Quadratic, linear and constant components
+    glm::vec3 get_attenuation() const noexcept { return glm::vec3{a, b, c}; }
+
+    // Whether the shader samples this light's shadow map
+    bool is_shadowed() const noexcept { return shadowed; }
+
+    void set_shadowed(bool _shadowed) noexcept { shadowed = _shadowed; }
+
 protected:
+    // For derived lights that create their own kind of shadow map
+    PointLight(GLfloat near, GLfloat far,
+               GLfloat red, GLfloat green, GLfloat blue, GLfloat _ambient_intensity, GLfloat _diffuse_intensity,
+               GLfloat pos_x, GLfloat pos_y, GLfloat pos_z, GLfloat _a, GLfloat _b, GLfloat _c) noexcept;
+
+    GLfloat near_plane{0};
     GLfloat far_plane{0};
     glm::vec3 position{0.f, 0.f, 0.f};
     GLfloat a; // Quadratic component in the equation
     GLfloat b; // Linear component in the equation
     GLfloat c; // Constant component in the equation
+    bool shadowed{true};
 };
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <BSlogger.hpp>
+
+#include <BoundingBox.hpp>
+#include <DrawList.hpp>
+#include <SoftwareOcclusion.hpp>
+
+// Visibility of the static items of a DrawList, baked offline per view cell.
+// The region around the static items is split into a grid of cells, and each
+// cell keeps one bit per item: set when the item may be seen from somewhere
+// in the cell. At runtime the camera's cell is found in constant time and
+// static items whose bit is clear are dropped before any other culling.
+//
+// Baking samples points spread over each cell and, from every point, the six
+// faces of a cube around it, each face rasterizing the static occluders with
+// SoftwareOcclusion and testing the items against them. Cells are spread over
+// worker threads. Being sampled, a set can miss an item glimpsed only through
+// a gap narrower than the sample spacing.
+//
+// Items are identified by their index in the DrawList, so a baked file only
+// matches the scene it was baked from. Items that are not static are always
+// potentially visible, and so is everything while the camera is outside the grid.
+class PotentiallyVisibleSet
+{
+public:
+    static constexpr GLfloat CELL_SIZE{5.f};
+
+    // Above this the region is too large to bake, and a file asking for more is damaged
+    static constexpr size_t MAX_CELLS{1u << 20};
+
+    // Empty space baked around the static items, where the camera may still go
+    static constexpr GLfloat MARGIN{10.f};
+
+    static constexpr size_t SAMPLES_PER_AXIS{3};
+    static constexpr GLuint SAMPLE_RESOLUTION{128};
+
+    PotentiallyVisibleSet() = default;
+
+    PotentiallyVisibleSet(const PotentiallyVisibleSet&) = delete;
+
+    PotentiallyVisibleSet& operator=(const PotentiallyVisibleSet&) = delete;
+
+    // The draw list must hold the scene, its static items where they stay
+    bool bake(const DrawList& draw_list, GLfloat near_plane, GLfloat far_plane) noexcept;
+
+    bool save(const std::filesystem::path& path) const noexcept;
+
+    // Fails when the file is missing, damaged or baked from a draw list of another size
+    bool load(const std::filesystem::path& path, const DrawList& draw_list) noexcept;
+
+    // Selects the set of the cell holding the position
+    void set_position(const glm::vec3& position) noexcept;
+
+    // For the position last set; constant time
+    bool is_visible(size_t item) const noexcept
+    {
+        return !current || item >= num_items || ((current[item / 64] >> (item % 64)) & 1u) != 0;
+    }
+
+    bool is_baked() const noexcept { return !bits.empty(); }
+
+private:
+    // Sets the bits of the items seen from the cell, with occlusion as the worker's own buffer
+    void bake_cell(const DrawList& draw_list, size_t cell, const glm::mat4& projection, SoftwareOcclusion& occlusion) noexcept;
+
+    glm::vec3 origin{0.f};
+    std::array<GLuint, 3> num_cells{0, 0, 0};
+    size_t num_items{0};
+    size_t words_per_cell{0};
+    std::vector<std::uint64_t> bits;
+    const std::uint64_t* current{nullptr};
+};
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <filesystem>
 #include <memory>
 #include <string>
@@ -13,6 +14,7 @@
 #include <BSlogger.hpp>
 
 #include <DirectionalLight.hpp>
+#include <LightTable.hpp>
 #include <PointLight.hpp>
 #include <SpotLight.hpp>
 
@@ -40,18 +42,18 @@ public:
 
     static std::shared_ptr<Shader> create_from_files(std::filesystem::path vertex_shader_path, std::filesystem::path geometry_shader_path, std::filesystem::path fragment_shader_path) noexcept;
 
+    // Program without a fragment shader, for passes that only write hardware depth
+    static std::shared_ptr<Shader> create_depth_only_from_files(std::filesystem::path vertex_shader_path, std::filesystem::path geometry_shader_path = {}) noexcept;
+
+    // Compute program, only for contexts of GL 4.3 or later
+    static std::shared_ptr<Shader> create_compute_from_file(std::filesystem::path compute_shader_path) noexcept;
+
     GLuint get_uniform_projection_id() const noexcept { return uniform_projection_id; }
 
     GLuint get_uniform_view_id() const noexcept { return uniform_view_id; }
 
-    GLuint get_uniform_model_id() const noexcept { return uniform_model_id; }
-
     GLuint get_uniform_eye_position_id() const noexcept { return uniform_eye_position_id; }
 
-    GLuint get_uniform_specular_intensity_id() const noexcept { return uniform_specular_intensity_id; }
-
-    GLuint get_uniform_specular_shininess_id() const noexcept { return uniform_specular_shininess_id; }
-
     GLuint get_uniform_omnidirectional_light_position_id() const noexcept { return uniform_omnidirectional_light_position_id; }
 
     GLuint get_uniform_far_plane_id() const noexcept { return uniform_far_plane_id; }
@@ -60,22 +62,81 @@ public:
 
     void set_directional_light(std::shared_ptr<DirectionalLight> light) const noexcept;
     
-    void set_point_lights(const std::vector<std::shared_ptr<PointLight>>& lights, unsigned int texture_unit, size_t offset) const noexcept;
+    void set_point_lights(const std::vector<std::shared_ptr<PointLight>>& lights, unsigned int texture_unit) const noexcept;
 
-    void set_spot_lights(const std::vector<std::shared_ptr<SpotLight>>& lights, unsigned int texture_unit, size_t offset) const noexcept;
+    void set_spot_lights(const std::vector<std::shared_ptr<SpotLight>>& lights, const LightTable& table, unsigned int texture_unit) const noexcept;
 
     void set_texture(GLenum texture_unit) const noexcept;
 
+    // Texture buffer of DrawList with the model matrices and materials of every draw
+    void set_draw_data(GLuint texture_unit) const noexcept;
+
     void set_directional_shadow_map(GLenum texture_unit) const noexcept;
 
-    void set_directional_light_space_transform(const glm::mat4& directional_light_space_transform) const noexcept;
+    void set_light_space_transform(const glm::mat4& light_space_transform) const noexcept;
+
+    void set_directional_light_space_transforms(const std::vector<glm::mat4>& directional_light_space_transforms) const noexcept;
+
+    void set_cascade_splits(const std::vector<GLfloat>& cascade_splits) const noexcept;
+
+    void set_omnidirectional_light_matrices(const LightTable::FaceTransforms& matrices) const noexcept;
+
+    void set_omnidirectional_layer_offset(GLint layer_offset) const noexcept;
+
+    void set_omnidirectional_face(GLint face) const noexcept;
+
+    void set_shadow_filter(GLint texture_unit, GLint source_layer, const glm::vec2& texel_step, bool convert_depth) const noexcept;
+
+    void set_shadow_filter_mode(GLint mode) const noexcept;
+
+    void set_directional_moments(GLint texture_unit) const noexcept;
+
+    void set_omnidirectional_moments(GLint texture_unit) const noexcept;
+
+    void set_pcf_mode(GLint mode) const noexcept;
 
-    void set_omnidirectional_light_matrices(const std::vector<glm::mat4>& matrices) const noexcept;
+    void set_show_shadow_samples(bool show) const noexcept;
+
+    void set_omnidirectional_hardware_depth(bool hardware_depth) const noexcept;
+
+    // Where the shadow mask pass rebuilds world positions from
+    void set_shadow_mask_reconstruction(GLuint depth_texture_unit, const glm::mat4& inverse_view_projection) const noexcept;
+
+    void set_shadow_mask(bool enabled, GLuint mask_texture_unit, GLuint depth_texture_unit, const glm::vec2& scale) const noexcept;
+
+    // Targets of the geometry pass and how the lighting pass rebuilds positions from their depth
+    void set_gbuffer(GLuint albedo_specular_texture_unit, GLuint normal_shininess_texture_unit, GLuint depth_texture_unit,
+                     const glm::mat4& inverse_view_projection) const noexcept;
+
+    // Texture buffers of LightClusters, the tiles per window pixel and the depth slicing
+    void set_light_clusters(GLuint lights_texture_unit, GLuint table_texture_unit, GLuint indices_texture_unit,
+                            GLuint num_point_lights, const glm::vec2& tile_scale, const glm::vec2& depth_slicing) const noexcept;
+
+    // For the ESM conversion of cubes that store hardware depth
+    void set_depth_linearization(bool hardware_depth, GLfloat near_plane, GLfloat far_plane) const noexcept;
+
+    void set_directional_shadow_comparison(GLint texture_unit) const noexcept;
+
+    void set_spot_shadow_comparison(GLint texture_unit) const noexcept;
+
+    // Box drawn by occlusion_box.vert
+    void set_bounds(const glm::vec3& bounds_min, const glm::vec3& bounds_max) const noexcept;
+
+    // Level of the depth texture or pyramid the next reduction step reads
+    void set_depth_reduction(GLuint source_texture_unit, GLint source_level) const noexcept;
+
+    // Objects the culling pass tests and the frustum planes they are tested against
+    void set_culling(GLuint num_objects, const std::array<glm::vec4, 6>& frustum_planes) const noexcept;
+
+    // Depth pyramid of an earlier frame, the view projection it was rendered with and the size of its source depth
+    void set_occlusion_culling(bool enabled, GLuint depth_pyramid_texture_unit, const glm::mat4& view_projection,
+                               const glm::ivec2& depth_size, GLint num_levels) const noexcept;
 
 private:
     void clear() noexcept;
 
-    void create_program(std::string_view vertex_shader_code, std::string_view geometry_shader_code, std::string_view fragment_shader_code) noexcept;
+    void create_program(std::string_view vertex_shader_code, std::string_view geometry_shader_code, std::string_view fragment_shader_code,
+                        std::string_view compute_shader_code = "") noexcept;
 
     void create_shader(std::string_view shader_code, GLenum shader_type) noexcept;
 
@@ -84,16 +145,60 @@ private:
     GLuint program_id{0};
     GLuint uniform_projection_id{0};
     GLuint uniform_view_id{0};
-    GLuint uniform_model_id{0};
     GLuint uniform_eye_position_id{0};
-    GLuint uniform_specular_intensity_id{0};
-    GLuint uniform_specular_shininess_id{0};
-    GLuint uniform_directional_light_space_transform_id{0};
+    GLuint uniform_light_space_transform_id{0};
+    GLuint uniform_directional_light_space_transform_ids[CascadedShadowMap::MAX_CASCADES];
+    GLuint uniform_cascade_split_ids[CascadedShadowMap::MAX_CASCADES];
+    GLuint uniform_num_cascades_id{0};
     GLuint uniform_directional_shadow_map_id{0};
     GLuint uniform_texture_id{0};
+    GLuint uniform_draw_data_id{0};
     GLuint uniform_omnidirectional_light_position_id{0};
     GLuint uniform_far_plane_id{0};
     GLuint uniform_light_matrix_ids[OmnidirectionalShadowMap::NUM_FACES];
+    GLuint uniform_face_id{0};
+    GLuint uniform_layer_offset_id{0};
+    GLuint uniform_omnidirectional_shadow_map_array_id{0};
+    GLuint uniform_spot_shadow_atlas_id{0};
+    GLuint uniform_source_id{0};
+    GLuint uniform_source_layer_id{0};
+    GLuint uniform_texel_step_id{0};
+    GLuint uniform_convert_depth_id{0};
+    GLuint uniform_shadow_filter_mode_id{0};
+    GLuint uniform_directional_moments_id{0};
+    GLuint uniform_omnidirectional_moments_id{0};
+    GLuint uniform_pcf_mode_id{0};
+    GLuint uniform_show_shadow_samples_id{0};
+    GLuint uniform_omnidirectional_hardware_depth_id{0};
+    GLuint uniform_hardware_depth_id{0};
+    GLuint uniform_near_plane_id{0};
+    GLuint uniform_scene_depth_id{0};
+    GLuint uniform_inverse_view_projection_id{0};
+    GLuint uniform_shadow_mask_enabled_id{0};
+    GLuint uniform_shadow_mask_id{0};
+    GLuint uniform_shadow_mask_depth_id{0};
+    GLuint uniform_shadow_mask_scale_id{0};
+    GLuint uniform_gbuffer_albedo_specular_id{0};
+    GLuint uniform_gbuffer_normal_shininess_id{0};
+    GLuint uniform_gbuffer_depth_id{0};
+    GLuint uniform_cluster_lights_id{0};
+    GLuint uniform_cluster_table_id{0};
+    GLuint uniform_cluster_light_indices_id{0};
+    GLuint uniform_num_cluster_point_lights_id{0};
+    GLuint uniform_cluster_tile_scale_id{0};
+    GLuint uniform_cluster_depth_slicing_id{0};
+    GLuint uniform_directional_shadow_comparison_id{0};
+    GLuint uniform_spot_shadow_comparison_id{0};
+    GLuint uniform_bounds_min_id{0};
+    GLuint uniform_bounds_max_id{0};
+    GLuint uniform_source_level_id{0};
+    GLuint uniform_num_objects_id{0};
+    GLuint uniform_frustum_planes_id{0};
+    GLuint uniform_occlusion_culling_id{0};
+    GLuint uniform_depth_pyramid_id{0};
+    GLuint uniform_pyramid_view_projection_id{0};
+    GLuint uniform_depth_size_id{0};
+    GLuint uniform_pyramid_levels_id{0};
     
     struct
     {
@@ -133,7 +238,14 @@ private:
 
     struct
     {
-        GLuint uniform_shadow_map_id;
+        GLuint uniform_cube_id;
+        GLuint uniform_near_plane_id;
         GLuint uniform_far_plane_id;
-    } uniform_omnidirectional_shadow_maps[MAX_POINT_LIGHTS + MAX_SPOT_LIGHTS];
+    } uniform_omnidirectional_shadow_maps[MAX_POINT_LIGHTS];
+
+    struct
+    {
+        GLuint uniform_uv_scale_offset_id;
+        GLuint uniform_light_transform_id;
+    } uniform_spot_shadow_maps[MAX_SPOT_LIGHTS];
 };
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <BSlogger.hpp>
+
+// One large depth texture shared by many lights. Every frame it is split
+// into power-of-two square tiles following a quadtree, so each light gets
+// a resolution that matches how much of the screen it covers.
+class ShadowAtlas
+{
+public:
+    enum class DepthFormat
+    {
+        DEPTH16,
+        DEPTH24,
+        DEPTH32F
+    };
+
+    enum class Quality
+    {
+        LOW,
+        MEDIUM,
+        HIGH
+    };
+
+    struct Settings
+    {
+        DepthFormat depth_format;
+        size_t memory_budget; // Bytes the atlas texture may take
+        GLuint min_tile_size;
+    };
+
+    struct Tile
+    {
+        GLuint x{0};
+        GLuint y{0};
+        GLuint size{0}; // Zero when the light gets no shadow
+
+        bool operator == (const Tile& tile) const noexcept { return x == tile.x && y == tile.y && size == tile.size; }
+
+        bool operator != (const Tile& tile) const noexcept { return !(*this == tile); }
+    };
+
+    static Settings get_settings(Quality quality) noexcept;
+
+    ShadowAtlas(const Settings& _settings) noexcept;
+
+    ShadowAtlas(const ShadowAtlas&) = delete;
+
+    ShadowAtlas& operator=(const ShadowAtlas&) = delete;
+
+    ~ShadowAtlas();
+
+    bool init() noexcept;
+
+    // Tile size for a light covering that fraction of the screen height (0 means none)
+    GLuint get_tile_size(GLfloat coverage, GLuint screen_height) const noexcept;
+
+    // Returns one tile per request, in the same order. Requests that do not fit are halved.
+    std::vector<Tile> allocate(const std::vector<GLuint>& requested_sizes) const noexcept;
+
+    // Binds the atlas and restricts viewport and scissor to the tile
+    void write(const Tile& tile) const noexcept;
+
+    void read(GLenum texture_unit) const noexcept;
+
+    // xy: scale, zw: offset from the light's [0, 1] coordinates to the atlas
+    glm::vec4 get_uv_scale_offset(const Tile& tile) const noexcept;
+
+    GLuint get_size() const noexcept { return size; }
+
+private:
+    Settings settings;
+    GLuint size{0};
+    GLuint FBO_id{0};
+    GLuint shadow_map_id{0};
+};
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <BSlogger.hpp>
+
+#include <CascadedShadowMap.hpp>
+#include <OmnidirectionalShadowMap.hpp>
+#include <Shader.hpp>
+
+// Turns depth shadow maps into prefiltered moment maps: EVSM for the
+// cascades and ESM for the point light cubes. Each map is converted and
+// blurred horizontally into a temporary texture, blurred vertically into
+// its moment texture and then mipmapped, so the lighting shader needs a
+// single filtered fetch per light. The cubes share one array, which is
+// mipmapped once after all of the frame's point lights are filtered.
+class ShadowFilter
+{
+public:
+    enum class Mode
+    {
+        PCF,      // Depth comparisons in the lighting shader
+        FILTERED  // EVSM/ESM moments, one fetch per light
+    };
+
+    ShadowFilter(std::shared_ptr<Shader> _evsm_shader, std::shared_ptr<Shader> _esm_shader) noexcept;
+
+    ShadowFilter(const ShadowFilter&) = delete;
+
+    ShadowFilter& operator=(const ShadowFilter&) = delete;
+
+    ~ShadowFilter();
+
+    bool init() noexcept;
+
+    void filter(CascadedShadowMap& shadow_map) noexcept;
+
+    // With hardware_depth the cube holds perspective depth of the given planes
+    void filter(OmnidirectionalShadowMap& shadow_map, bool hardware_depth = false, GLfloat near_plane = 0.f, GLfloat far_plane = 1.f) noexcept;
+
+    // Mipmaps the cube moments filtered since the last call
+    void generate_omnidirectional_mipmaps() noexcept;
+
+private:
+    struct Temporary
+    {
+        GLuint texture_id{0};
+        GLuint width{0};
+        GLuint height{0};
+    };
+
+    // (Re)creates a single-layer (or single-cube) target when the size changes
+    void resize_temporary(Temporary& temporary, GLenum target, GLenum internal_format, GLenum format, GLuint w, GLuint h, GLuint layers) noexcept;
+
+    void begin() const noexcept;
+
+    void end() const noexcept;
+
+    std::shared_ptr<Shader> evsm_shader{nullptr};
+    std::shared_ptr<Shader> esm_shader{nullptr};
+    GLuint FBO_id{0};
+    GLuint VAO_id{0};
+    Temporary evsm_temporary{};
+    Temporary esm_temporary{};
+
+    // Cube array written by filter and not yet mipmapped
+    std::shared_ptr<OmnidirectionalShadowMapArray> unmipmapped_storage{nullptr};
+};
\ No newline at end of file
@@ -7,6 +7,15 @@
 class ShadowMap
 {
 public:
+    // How the lighting shader filters depth comparisons
+    enum class PCFMode
+    {
+        NONE,             // One comparison
+        MANUAL_3X3,       // Nine fetches compared in the shader
+        HARDWARE_2X2,     // One comparison sampler fetch, bilinear 2x2 PCF
+        HARDWARE_POISSON  // Nine comparison sampler fetches on a Poisson disk
+    };
+
     ShadowMap() = default;
 
     virtual ~ShadowMap();
@@ -17,13 +26,27 @@ public:
 
     virtual void read(GLenum texture_unit) noexcept;
 
+    // Binds the map with a depth-comparison sampler, for the sampler*Shadow lookups
+    void read_comparison(GLenum texture_unit) noexcept;
+
     GLuint get_width() const noexcept { return width; }
 
     GLuint get_height() const noexcept { return height; }
 
+    GLuint get_shadow_map_id() const noexcept { return shadow_map_id; }
+
+    bool is_dirty() const noexcept { return dirty; }
+
+    void mark_dirty() noexcept { dirty = true; }
+
+    void mark_clean() noexcept { dirty = false; }
+
 protected:
+    static GLuint get_comparison_sampler() noexcept;
+
     GLuint FBO_id{0};
     GLuint shadow_map_id{0};
     GLuint width{0};
     GLuint height{0};
+    bool dirty{true};
 };
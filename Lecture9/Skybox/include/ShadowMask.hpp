@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <BSlogger.hpp>
+
+#include <Shader.hpp>
+
+// Screen-space shadow visibility of the directional light and the point
+// lights. A depth prepass gives the visible surface of every pixel, the
+// shadows are evaluated once per texel of a reduced-resolution mask and the
+// lighting shader upsamples the mask with depth-aware weights instead of
+// filtering the shadow maps for every shaded fragment. The full resolution
+// depth is a transient target of the frame graph, only the mask is kept.
+class ShadowMask
+{
+public:
+    // Must match NUM_MASK_LAYERS in shadow_mask.frag and shader.frag: the
+    // directional light and then one channel per point light, four per layer
+    static constexpr size_t NUM_LAYERS{3};
+
+    enum class Resolution
+    {
+        HALF = 2,
+        QUARTER = 4
+    };
+
+    ShadowMask(std::shared_ptr<Shader> _mask_shader) noexcept;
+
+    ShadowMask(const ShadowMask&) = delete;
+
+    ShadowMask& operator=(const ShadowMask&) = delete;
+
+    ~ShadowMask();
+
+    // The prepass depth is w x h, the mask is divided by the resolution
+    bool init(GLuint w, GLuint h, Resolution _resolution) noexcept;
+
+    bool set_resolution(Resolution _resolution) noexcept;
+
+    // Fills the mask from the w x h prepass depth. The mask shader must be in
+    // use with its lights and shadow maps already set.
+    void evaluate(const glm::mat4& projection, const glm::mat4& view, GLuint depth_texture_id, GLuint depth_texture_unit) const noexcept;
+
+    void read(GLenum mask_texture_unit, GLenum depth_texture_unit) const noexcept;
+
+    // Mask texels per window pixel
+    glm::vec2 get_scale() const noexcept;
+
+    Resolution get_resolution() const noexcept { return resolution; }
+
+private:
+    bool create_targets() noexcept;
+
+    void clear_targets() noexcept;
+
+    std::shared_ptr<Shader> mask_shader{nullptr};
+    GLuint mask_FBO_id{0};
+    GLuint mask_id{0};
+    GLuint mask_depth_id{0};
+    GLuint VAO_id{0};
+    GLuint width{0};
+    GLuint height{0};
+    GLuint mask_width{0};
+    GLuint mask_height{0};
+    Resolution resolution{Resolution::HALF};
+};
\ No newline at end of file
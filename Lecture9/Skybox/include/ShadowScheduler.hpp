@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <PointLight.hpp>
+
+// Spreads point light shadow updates over several frames. Every frame a
+// fixed budget of cube faces goes to the dirty lights with the highest
+// importance. A light is charged the faces its pass draws into, as counted
+// by the caller for its shadow mode; faces that are only cleared are free.
+// Lights left out wait and gain priority, so the far ones still update
+// round-robin. Lights covering too little of the screen are unshadowed.
+class ShadowScheduler
+{
+public:
+    // Below this fraction of the screen height a light is drawn without shadow
+    static constexpr GLfloat MIN_COVERAGE{0.02f};
+
+    // Faces the pass of the light at the given index draws into, only asked for dirty lights
+    using FaceCount = std::function<GLuint(size_t)>;
+
+    ShadowScheduler(GLuint _face_budget) noexcept;
+
+    // Coverages are given per light, in the same order. Returns the lights to render this frame.
+    std::vector<std::shared_ptr<PointLight>> schedule(const std::vector<std::shared_ptr<PointLight>>& lights, const std::vector<GLfloat>& coverages, const FaceCount& count_faces) noexcept;
+
+    GLuint get_face_budget() const noexcept { return face_budget; }
+
+    void set_face_budget(GLuint _face_budget) noexcept { face_budget = _face_budget; }
+
+private:
+    struct State
+    {
+        GLuint frames_waiting{0};
+        bool rendered{false}; // The cube holds a valid, maybe stale, shadow
+    };
+
+    GLuint face_budget{0};
+    std::unordered_map<const PointLight*, State> states;
+};
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <BSlogger.hpp>
+
+#include <BoundingBox.hpp>
+#include <DrawList.hpp>
+#include <WorkerPool.hpp>
+
+// Occlusion culling entirely on the CPU. The occluder items of a DrawList
+// are rasterized, through their meshes' occluder triangles, into a small
+// depth buffer, and boxes are tested against it before anything is
+// submitted. No GPU readback is involved, so it behaves the same on any
+// driver, software rasterizers included.
+//
+// Both sides stay conservative: an occluder only writes the pixels its
+// triangle covers entirely, with the farthest depth its plane reaches over
+// the pixel, and a box is hidden only if it is behind every pixel it
+// touches. Rows are rasterized four pixels at a time with SSE when
+// SKYBOX_SIMD is defined, and the buffer is split in bands of tile rows
+// spread over the shared worker pool. Every tile keeps its farthest depth, so
+// most tiles of a box are settled without looking at their pixels.
+class SoftwareOcclusion
+{
+public:
+    static constexpr GLuint TILE_SIZE{8};
+
+    // Below this many triangles waking the workers costs more than the rasterization itself
+    static constexpr size_t PARALLEL_THRESHOLD{256};
+
+    static constexpr size_t REPORT_INTERVAL{300};
+
+    // Multiples of TILE_SIZE. Callers that already spread their work over threads turn parallel off
+    // and never touch the worker pool.
+    SoftwareOcclusion(std::string_view _name, GLuint w, GLuint h, bool _parallel = true) noexcept;
+
+    SoftwareOcclusion(const SoftwareOcclusion&) = delete;
+
+    SoftwareOcclusion& operator=(const SoftwareOcclusion&) = delete;
+
+    // Clears the buffer and rasterizes the occluders seen through view_projection,
+    // only the static ones when baking visibility that must hold whatever moves
+    void render(const DrawList& draw_list, const glm::mat4& view_projection, bool static_only = false) noexcept;
+
+    // False only when the box is behind the occluders everywhere it covers
+    bool is_visible(const BoundingBox& bounds) noexcept;
+
+    // Logs the triangles rasterized and the boxes tested and hidden every REPORT_INTERVAL frames
+    void end_frame() noexcept;
+
+private:
+    // Screen-space setup of one triangle, inside where all three edges are non-negative.
+    // The edge offsets already hold the half pixel that makes coverage whole-pixel, and
+    // the depth offset the half pixel that makes depth the farthest over the pixel.
+    struct Triangle
+    {
+        std::array<GLfloat, 3> edge_x;
+        std::array<GLfloat, 3> edge_y;
+        std::array<GLfloat, 3> edge_offset;
+        GLfloat depth_x;
+        GLfloat depth_y;
+        GLfloat depth_offset;
+        GLint min_x;
+        GLint max_x;
+        GLint min_y;
+        GLint max_y;
+    };
+
+    // Clips against the near plane and sets up what is left
+    void add_triangle(const std::array<glm::vec4, 3>& clip) noexcept;
+
+    void setup_triangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2) noexcept;
+
+    // Rasterizes the rows of [first_row, last_row) and updates the farthest depth of their tiles
+    void rasterize_band(GLuint first_row, GLuint last_row) noexcept;
+
+    std::string name;
+    GLuint width{0};
+    GLuint height{0};
+    GLuint tiles_x{0};
+    GLuint tiles_y{0};
+    glm::mat4 view_projection{1.f};
+    bool rendered{false};
+
+    std::vector<GLfloat> depth;
+    std::vector<GLfloat> tile_depth;
+    std::vector<Triangle> triangles;
+
+    size_t num_frames{0};
+    size_t num_triangles{0};
+    size_t num_tested{0};
+    size_t num_hidden{0};
+
+    // Null unless parallel
+    std::shared_ptr<WorkerPool> workers;
+};
\ No newline at end of file
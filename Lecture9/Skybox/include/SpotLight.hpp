@@ -1,5 +1,6 @@
 #pragma once
 
+#include <AtlasShadowMap.hpp>
 #include <PointLight.hpp>
 
 class SpotLight: public PointLight
@@ -7,7 +8,7 @@ class SpotLight: public PointLight
 public:
     SpotLight() = default;
 
-    SpotLight(GLuint shadow_width, GLuint shadow_height,
+    SpotLight(std::shared_ptr<ShadowAtlas> shadow_atlas,
               GLfloat near, GLfloat far,
               GLfloat red, GLfloat green, GLfloat blue, GLfloat _ambient_intensity, GLfloat _diffuse_intensity,
               GLfloat pos_x, GLfloat pos_y, GLfloat pos_z, GLfloat _a, GLfloat _b, GLfloat _c,
@@ -21,6 +22,18 @@ public:
 
     void set(const glm::vec3& pos, const glm::vec3& dir) noexcept;
 
+    glm::mat4 get_light_transform() const noexcept override;
+
+    bool shadow_volume_intersects(const BoundingBox& bounds) const noexcept override;
+
+    // Tightest sphere around the cone, much smaller than the range sphere for narrow cones
+    glm::vec4 get_bounding_sphere() const noexcept override;
+
+    const glm::vec3& get_direction() const noexcept { return direction; }
+
+    // Cosine of the cone's half angle
+    GLfloat get_cos_edge() const noexcept { return proc_edge; }
+
 private:
     glm::vec3 direction;
     GLfloat edge;
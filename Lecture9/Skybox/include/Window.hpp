@@ -3,6 +3,7 @@
 #include <array>
 #include <memory>
 #include <string_view>
+#include <utility>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
@@ -24,6 +25,9 @@ public:
 
     Window& operator = (Window&& window) = delete;
 
+    // Versions tried in order: 4.3 brings compute shaders and indirect draws, the rest of the renderer needs 4.1
+    static constexpr std::array<std::pair<GLint, GLint>, 4> CONTEXT_VERSIONS{{{4, 6}, {4, 5}, {4, 3}, {4, 1}}};
+
     static std::shared_ptr<Window> create(GLint width, GLint height, std::string_view title) noexcept;
 
     GLint get_buffer_width() const noexcept { return buffer_width; }
@@ -32,6 +36,10 @@ public:
 
     GLfloat get_aspect_ratio() const noexcept;
 
+    GLint get_context_major_version() const noexcept { return context_major_version; }
+
+    GLint get_context_minor_version() const noexcept { return context_minor_version; }
+
     GLfloat get_x_change() noexcept;
 
     GLfloat get_y_change() noexcept;
@@ -48,6 +56,8 @@ private:
     GLint height{0};
     GLint buffer_width{0};
     GLint buffer_height{0};
+    GLint context_major_version{0};
+    GLint context_minor_version{0};
 
     GLfloat last_x{0.f};
     GLfloat last_y{0.f};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads started once and parked between jobs, so per frame work can be
+// spread over the cores without creating threads every frame. A job is a
+// number of independent tasks; the calling thread takes tasks too and
+// returns when all of them are done. Only one thread may run jobs at a time.
+class WorkerPool
+{
+public:
+    using Task = std::function<void(size_t)>;
+
+    // Shared pool, created on first use and stopped with its last user
+    static std::shared_ptr<WorkerPool> get_instance() noexcept;
+
+    // The calling thread counts as one worker, so one thread fewer is started
+    explicit WorkerPool(size_t num_workers) noexcept;
+
+    WorkerPool(const WorkerPool&) = delete;
+
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool();
+
+    // Calls task(i) for every i below num_tasks
+    void run(size_t num_tasks, const Task& task) noexcept;
+
+    size_t get_num_workers() const noexcept { return threads.size() + 1; }
+
+private:
+    void work() noexcept;
+
+    static std::weak_ptr<WorkerPool> instance;
+
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // Guarded by the mutex; the next task index is only reset while no worker is active
+    const Task* task{nullptr};
+    size_t num_tasks{0};
+    size_t job{0};
+    size_t active{0};
+    bool stopping{false};
+
+    std::atomic<size_t> next_task{0};
+};
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <array>
 #include <iostream>
 #include <string>
 
@@ -8,24 +9,69 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <BoundingBox.hpp>
 #include <Camera.hpp>
+#include <DepthPyramid.hpp>
 #include <DirectionalLight.hpp>
+#include <DrawList.hpp>
+#include <FrameGraph.hpp>
+#include <Frustum.hpp>
+#include <GBuffer.hpp>
+#include <GpuCulling.hpp>
+#include <LightClusters.hpp>
+#include <LightTable.hpp>
 #include <Material.hpp>
 #include <Mesh.hpp>
 #include <Model.hpp>
+#include <OcclusionCulling.hpp>
+#include <OverdrawCounter.hpp>
+#include <PassTimer.hpp>
 #include <PointLight.hpp>
+#include <PotentiallyVisibleSet.hpp>
 #include <Shader.hpp>
+#include <ShadowAtlas.hpp>
+#include <ShadowFilter.hpp>
+#include <ShadowMask.hpp>
+#include <ShadowScheduler.hpp>
 #include <SkyBox.hpp>
+#include <SoftwareOcclusion.hpp>
 #include <SpotLight.hpp>
 #include <Texture.hpp>
 #include <Window.hpp>
 
 namespace fs = std::filesystem;
 
+enum class DepthPrepassMode
+{
+    AUTO,
+    ALWAYS,
+    NEVER
+};
+
+// How the passes from the camera skip what it cannot see
+enum class CameraCulling
+{
+    FRUSTUM,
+    SOFTWARE_OCCLUSION,
+    OCCLUSION_QUERIES,
+    GPU
+};
+
 struct Data
 {
     static constexpr GLint WIDTH = 1024;
     static constexpr GLint HEIGHT = 768;
+    static constexpr GLfloat FIELD_OF_VIEW = 60.f;
+    static constexpr GLfloat NEAR_PLANE = 0.1f;
+    static constexpr GLfloat FAR_PLANE = 100.f;
+    static constexpr GLfloat BLACK_HAWK_ANGULAR_SPEED = 12.f; // degrees per second
+    static constexpr ShadowAtlas::Quality SHADOW_QUALITY = ShadowAtlas::Quality::HIGH;
+    static constexpr GLuint SHADOW_FACE_BUDGET = 12; // cube faces rendered per frame
+    static constexpr GLuint DRAW_DATA_TEXTURE_UNIT = 15;
+    static constexpr GLuint DEPTH_PYRAMID_TEXTURE_UNIT = 16;
+    // Overdraw above which the forward pass lays down depth first, and below which it stops again
+    static constexpr double DEPTH_PREPASS_ENABLE_OVERDRAW = 1.6;
+    static constexpr double DEPTH_PREPASS_DISABLE_OVERDRAW = 1.3;
     static std::shared_ptr<SkyBox> sky_box;
     static std::vector<std::shared_ptr<Shader>> shader_list;
     static std::vector<std::shared_ptr<Mesh>> mesh_list;
@@ -36,24 +82,77 @@ struct Data
     static std::shared_ptr<DirectionalLight> main_light;
     static std::vector<std::shared_ptr<PointLight>> point_lights;
     static std::vector<std::shared_ptr<SpotLight>> spot_lights;
+    static std::shared_ptr<ShadowAtlas> shadow_atlas;
+    static std::shared_ptr<ShadowScheduler> shadow_scheduler;
+    static std::shared_ptr<ShadowFilter> shadow_filter;
+    static ShadowFilter::Mode shadow_filter_mode;
+    static ShadowMap::PCFMode pcf_mode;
+    static bool show_shadow_samples;
+    static std::shared_ptr<ShadowMask> shadow_mask;
+    static std::shared_ptr<LightTable> light_table;
+    static std::shared_ptr<LightClusters> light_clusters;
+    static std::shared_ptr<FrameGraph> frame_graph;
+    static bool deferred_shading;
+    static GLuint fullscreen_VAO_id;
+    static std::shared_ptr<PassTimer> geometry_timer;
+    static bool shadow_mask_enabled;
+    static std::shared_ptr<Shader> depth_prepass_shader;
+    static DepthPrepassMode depth_prepass_mode;
+    static bool depth_prepass;
+    static std::shared_ptr<OverdrawCounter> overdraw_counter;
+    static Frustum view_frustum;
+    static std::shared_ptr<GpuCulling> gpu_culling; // nullptr below GL 4.3
+    static std::shared_ptr<DepthPyramid> depth_pyramid;
+    static std::shared_ptr<OcclusionCulling> occlusion_culling;
+    static std::shared_ptr<SoftwareOcclusion> camera_occlusion;
+    static std::shared_ptr<SoftwareOcclusion> shadow_occlusion;
+    static std::shared_ptr<PotentiallyVisibleSet> pvs;
+    static bool pvs_enabled;
+    static CameraCulling camera_culling;
+    static glm::mat4 pyramid_view_projection;
+    static bool depth_pyramid_built; // This frame, only when the GPU culling ran
+    static std::shared_ptr<PassTimer> lighting_timer;
     static const fs::path root_path;
     static const fs::path vertex_shader_path;
     static const fs::path fragment_shader_path;
     static const fs::path directional_shadow_map_vertex_shader_path;
+    static const fs::path directional_shadow_map_geometry_shader_path;
     static const fs::path directional_shadow_map_fragment_shader_path;
     static const fs::path omnidirectional_shadow_map_vertex_shader_path;
     static const fs::path omnidirectional_shadow_map_geometry_shader_path;
     static const fs::path omnidirectional_shadow_map_fragment_shader_path;
+    static const fs::path omnidirectional_shadow_map_face_vertex_shader_path;
+    static const fs::path omnidirectional_shadow_map_layered_vertex_shader_path;
+    static const fs::path spot_shadow_map_vertex_shader_path;
+    static const fs::path spot_shadow_map_fragment_shader_path;
+    static const fs::path shadow_filter_vertex_shader_path;
+    static const fs::path evsm_filter_fragment_shader_path;
+    static const fs::path esm_filter_fragment_shader_path;
+    static const fs::path depth_prepass_vertex_shader_path;
+    static const fs::path shadow_mask_fragment_shader_path;
+    static const fs::path gbuffer_fragment_shader_path;
+    static const fs::path deferred_lighting_fragment_shader_path;
+    static const fs::path cull_compute_shader_path;
+    static const fs::path depth_pyramid_compute_shader_path;
+    static const fs::path occlusion_box_vertex_shader_path;
+    static const fs::path pvs_path;
+
+    static OmnidirectionalShadowMap::Mode omnidirectional_shadow_mode;
+    static bool omnidirectional_hardware_depth;
+    static std::array<std::shared_ptr<Shader>, 3> omnidirectional_depth_shaders; // Indexed by OmnidirectionalShadowMap::Mode
+    static bool vertex_layer_supported;
+    static std::shared_ptr<PassTimer> omnidirectional_shadow_timer;
+    static std::array<bool, 1024> previous_keys;
 
     static float black_hawk_angle;
+    static glm::mat4 black_hawk_transform;
+    static BoundingBox black_hawk_bounds;
+    static std::shared_ptr<DrawList> draw_list;
 
     // Shader variable locations
     static GLuint uniform_projection_id;
-    static GLuint uniform_model_id;
     static GLuint uniform_view_id;
     static GLuint uniform_eye_position_id;
-    static GLuint uniform_specular_intensity_id;
-    static GLuint uniform_shininess_id;
     static GLuint uniform_directional_light_space_transform_id;
     static GLuint uniform_omnidirectional_light_position_id;
     static GLuint uniform_far_plane_id;
@@ -69,24 +168,77 @@ std::shared_ptr<Camera> Data::camera{nullptr};
 std::shared_ptr<DirectionalLight> Data::main_light{nullptr};
 std::vector<std::shared_ptr<PointLight>> Data::point_lights{};
 std::vector<std::shared_ptr<SpotLight>> Data::spot_lights{};
+std::shared_ptr<ShadowAtlas> Data::shadow_atlas{nullptr};
+std::shared_ptr<ShadowScheduler> Data::shadow_scheduler{nullptr};
+std::shared_ptr<ShadowFilter> Data::shadow_filter{nullptr};
+ShadowFilter::Mode Data::shadow_filter_mode{ShadowFilter::Mode::PCF};
+ShadowMap::PCFMode Data::pcf_mode{ShadowMap::PCFMode::MANUAL_3X3};
+bool Data::show_shadow_samples{false};
+std::shared_ptr<ShadowMask> Data::shadow_mask{nullptr};
+std::shared_ptr<LightTable> Data::light_table{nullptr};
+std::shared_ptr<LightClusters> Data::light_clusters{nullptr};
+std::shared_ptr<FrameGraph> Data::frame_graph{nullptr};
+bool Data::deferred_shading{false};
+GLuint Data::fullscreen_VAO_id{0};
+std::shared_ptr<PassTimer> Data::geometry_timer{nullptr};
+bool Data::shadow_mask_enabled{false};
+std::shared_ptr<Shader> Data::depth_prepass_shader{nullptr};
+DepthPrepassMode Data::depth_prepass_mode{DepthPrepassMode::AUTO};
+bool Data::depth_prepass{false};
+std::shared_ptr<OverdrawCounter> Data::overdraw_counter{nullptr};
+Frustum Data::view_frustum{};
+std::shared_ptr<GpuCulling> Data::gpu_culling{nullptr};
+std::shared_ptr<DepthPyramid> Data::depth_pyramid{nullptr};
+std::shared_ptr<OcclusionCulling> Data::occlusion_culling{nullptr};
+std::shared_ptr<SoftwareOcclusion> Data::camera_occlusion{nullptr};
+std::shared_ptr<SoftwareOcclusion> Data::shadow_occlusion{nullptr};
+std::shared_ptr<PotentiallyVisibleSet> Data::pvs{nullptr};
+bool Data::pvs_enabled{true};
+CameraCulling Data::camera_culling{CameraCulling::FRUSTUM};
+glm::mat4 Data::pyramid_view_projection{1.f};
+bool Data::depth_pyramid_built{false};
+std::shared_ptr<PassTimer> Data::lighting_timer{nullptr};
 
 const fs::path Data::root_path{fs::path{__FILE__}.parent_path()};
 const fs::path Data::vertex_shader_path{Data::root_path / "shaders" / "shader.vert"};
 const fs::path Data::fragment_shader_path{Data::root_path / "shaders" / "shader.frag"};
 const fs::path Data::directional_shadow_map_vertex_shader_path{Data::root_path / "shaders" / "directional_shadow_map.vert"};
+const fs::path Data::directional_shadow_map_geometry_shader_path{Data::root_path / "shaders" / "directional_shadow_map.geom"};
 const fs::path Data::directional_shadow_map_fragment_shader_path{Data::root_path / "shaders" / "directional_shadow_map.frag"};
 const fs::path Data::omnidirectional_shadow_map_vertex_shader_path{Data::root_path / "shaders" / "omnidirectional_shadow_map.vert"};
 const fs::path Data::omnidirectional_shadow_map_geometry_shader_path{Data::root_path / "shaders" / "omnidirectional_shadow_map.geom"};
 const fs::path Data::omnidirectional_shadow_map_fragment_shader_path{Data::root_path / "shaders" / "omnidirectional_shadow_map.frag"};
+const fs::path Data::omnidirectional_shadow_map_face_vertex_shader_path{Data::root_path / "shaders" / "omnidirectional_shadow_map_face.vert"};
+const fs::path Data::omnidirectional_shadow_map_layered_vertex_shader_path{Data::root_path / "shaders" / "omnidirectional_shadow_map_layered.vert"};
+const fs::path Data::spot_shadow_map_vertex_shader_path{Data::root_path / "shaders" / "spot_shadow_map.vert"};
+const fs::path Data::spot_shadow_map_fragment_shader_path{Data::root_path / "shaders" / "spot_shadow_map.frag"};
+const fs::path Data::shadow_filter_vertex_shader_path{Data::root_path / "shaders" / "shadow_filter.vert"};
+const fs::path Data::evsm_filter_fragment_shader_path{Data::root_path / "shaders" / "evsm_filter.frag"};
+const fs::path Data::esm_filter_fragment_shader_path{Data::root_path / "shaders" / "esm_filter.frag"};
+const fs::path Data::depth_prepass_vertex_shader_path{Data::root_path / "shaders" / "depth_prepass.vert"};
+const fs::path Data::shadow_mask_fragment_shader_path{Data::root_path / "shaders" / "shadow_mask.frag"};
+const fs::path Data::gbuffer_fragment_shader_path{Data::root_path / "shaders" / "gbuffer.frag"};
+const fs::path Data::deferred_lighting_fragment_shader_path{Data::root_path / "shaders" / "deferred_lighting.frag"};
+const fs::path Data::cull_compute_shader_path{Data::root_path / "shaders" / "cull.comp"};
+const fs::path Data::depth_pyramid_compute_shader_path{Data::root_path / "shaders" / "depth_pyramid.comp"};
+const fs::path Data::occlusion_box_vertex_shader_path{Data::root_path / "shaders" / "occlusion_box.vert"};
+const fs::path Data::pvs_path{Data::root_path / "scene.pvs"};
+
+OmnidirectionalShadowMap::Mode Data::omnidirectional_shadow_mode{OmnidirectionalShadowMap::Mode::GEOMETRY_SHADER};
+bool Data::omnidirectional_hardware_depth{false};
+std::array<std::shared_ptr<Shader>, 3> Data::omnidirectional_depth_shaders{};
+bool Data::vertex_layer_supported{false};
+std::shared_ptr<PassTimer> Data::omnidirectional_shadow_timer{nullptr};
+std::array<bool, 1024> Data::previous_keys{};
 
 float Data::black_hawk_angle{0.f};
+glm::mat4 Data::black_hawk_transform{1.f};
+BoundingBox Data::black_hawk_bounds{};
+std::shared_ptr<DrawList> Data::draw_list{nullptr};
 
 GLuint Data::uniform_projection_id{0};
-GLuint Data::uniform_model_id{0};
 GLuint Data::uniform_view_id{0};
 GLuint Data::uniform_eye_position_id{0};
-GLuint Data::uniform_specular_intensity_id{0};
-GLuint Data::uniform_shininess_id{0};
 GLuint Data::uniform_directional_light_space_transform_id{0};
 GLuint Data::uniform_omnidirectional_light_position_id{0};
 GLuint Data::uniform_far_plane_id{0};
@@ -169,15 +321,48 @@ void specify_vertices() noexcept
          10.f, 0.f,  10.f, 10.f, 10.f,  0.f, -1.f, 0.f
     };
 
-    Data::mesh_list.push_back(Mesh::create(vertices, indices));
-    Data::mesh_list.push_back(Mesh::create(vertices, indices));
-    Data::mesh_list.push_back(Mesh::create(floor_vertices, floor_indices));
+    Data::mesh_list.push_back(Mesh::create(vertices, indices, true));
+    Data::mesh_list.push_back(Mesh::create(vertices, indices, true));
+    Data::mesh_list.push_back(Mesh::create(floor_vertices, floor_indices, true));
 }
 void create_shaders_program() noexcept
 {
     Data::shader_list.push_back(Shader::create_from_files(Data::vertex_shader_path, Data::fragment_shader_path));
-    Data::shader_list.push_back(Shader::create_from_files(Data::directional_shadow_map_vertex_shader_path, Data::directional_shadow_map_fragment_shader_path));
+    Data::shader_list.push_back(Shader::create_from_files(Data::directional_shadow_map_vertex_shader_path, Data::directional_shadow_map_geometry_shader_path, Data::directional_shadow_map_fragment_shader_path));
     Data::shader_list.push_back(Shader::create_from_files(Data::omnidirectional_shadow_map_vertex_shader_path, Data::omnidirectional_shadow_map_geometry_shader_path, Data::omnidirectional_shadow_map_fragment_shader_path));
+    Data::shader_list.push_back(Shader::create_from_files(Data::omnidirectional_shadow_map_face_vertex_shader_path, Data::omnidirectional_shadow_map_fragment_shader_path));
+    Data::shader_list.push_back(Shader::create_from_files(Data::spot_shadow_map_vertex_shader_path, Data::spot_shadow_map_fragment_shader_path));
+
+    // Writing gl_Layer from the vertex shader needs an extension on a 4.1 context
+    Data::vertex_layer_supported = GLEW_ARB_shader_viewport_layer_array || GLEW_AMD_vertex_shader_layer;
+
+    if (Data::vertex_layer_supported)
+    {
+        Data::shader_list.push_back(Shader::create_from_files(Data::omnidirectional_shadow_map_layered_vertex_shader_path, Data::omnidirectional_shadow_map_fragment_shader_path));
+    }
+    else
+    {
+        Data::shader_list.push_back(nullptr);
+    }
+
+    Data::shader_list.push_back(Shader::create_from_files(Data::shadow_filter_vertex_shader_path, Data::shadow_mask_fragment_shader_path));
+    Data::depth_prepass_shader = Shader::create_depth_only_from_files(Data::depth_prepass_vertex_shader_path);
+
+    Data::shader_list.push_back(Shader::create_from_files(Data::vertex_shader_path, Data::gbuffer_fragment_shader_path));
+    Data::shader_list.push_back(Shader::create_from_files(Data::shadow_filter_vertex_shader_path, Data::deferred_lighting_fragment_shader_path));
+
+    // Fullscreen passes build their triangle from gl_VertexID, but a core context still needs a VAO
+    glGenVertexArrays(1, &Data::fullscreen_VAO_id);
+
+    // Same passes without the fragment shader: plain hardware depth keeps early-z and hierarchical-z enabled
+    auto& depth_shaders = Data::omnidirectional_depth_shaders;
+    depth_shaders[static_cast<size_t>(OmnidirectionalShadowMap::Mode::GEOMETRY_SHADER)] = Shader::create_depth_only_from_files(Data::omnidirectional_shadow_map_vertex_shader_path, Data::omnidirectional_shadow_map_geometry_shader_path);
+    depth_shaders[static_cast<size_t>(OmnidirectionalShadowMap::Mode::PER_FACE)] = Shader::create_depth_only_from_files(Data::omnidirectional_shadow_map_face_vertex_shader_path);
+
+    if (Data::vertex_layer_supported)
+    {
+        depth_shaders[static_cast<size_t>(OmnidirectionalShadowMap::Mode::VERTEX_LAYER)] = Shader::create_depth_only_from_files(Data::omnidirectional_shadow_map_layered_vertex_shader_path);
+    }
 }
 
 void create_textures_and_materials() noexcept
@@ -194,56 +379,176 @@ void create_textures_and_materials() noexcept
     Data::material_list.push_back(std::make_shared<Material>(0.3f, 4.f)); // Dull
 }
 
-void render_scene() noexcept
+void update_scene(GLfloat dt) noexcept
+{
+    Data::black_hawk_angle += Data::BLACK_HAWK_ANGULAR_SPEED * dt;
+
+	if (Data::black_hawk_angle > 360.0f)
+	{
+		Data::black_hawk_angle -= 360.f;
+	}
+
+    glm::mat4 model = glm::mat4(1.0f);
+	model = glm::rotate(model, to_radian(-Data::black_hawk_angle), glm::vec3(0.0f, 1.0f, 0.0f));
+	model = glm::translate(model, glm::vec3(-8.f, 2.f, 0.f));
+	model = glm::rotate(model, to_radian(-20.f), glm::vec3(0.f, 0.f, 1.f));
+	model = glm::rotate(model, to_radian(-90.f), glm::vec3(1.f, 0.f, 0.f));
+	model = glm::scale(model, glm::vec3(0.4f, 0.4f, 0.4f));
+    Data::black_hawk_transform = model;
+
+    // A moving caster affects the shadow maps around both its old and its new position
+    BoundingBox bounds = Data::model_list[1]->get_bounds().transform(model);
+    std::vector<BoundingBox> changed_bounds{Data::black_hawk_bounds, bounds};
+    Data::black_hawk_bounds = bounds;
+
+    Data::main_light->invalidate_shadow_map(changed_bounds);
+
+    for (auto light: Data::point_lights)
+    {
+        light->invalidate_shadow_map(changed_bounds);
+    }
+
+    for (auto light: Data::spot_lights)
+    {
+        light->invalidate_shadow_map(changed_bounds);
+    }
+}
+
+// Called once per frame after update_scene, every pass replays the same list
+void build_draw_list() noexcept
 {
+    Data::draw_list->clear();
+
     glm::mat4 model{1.f};
     model = glm::translate(model, glm::vec3{0.f, 2.f, -2.5f});
-    glUniformMatrix4fv(Data::uniform_model_id, 1, GL_FALSE, glm::value_ptr(model));
-    Data::texture_list[0]->use();
-    Data::material_list[0]->use(Data::uniform_specular_intensity_id, Data::uniform_shininess_id);
-    Data::mesh_list[0]->render();
+    Data::draw_list->add(Data::mesh_list[0], Data::texture_list[0], Data::material_list[0], model, DrawList::STATIC);
 
     model = glm::mat4{1.f};
     model = glm::translate(model, glm::vec3{0.f, 4.f, -2.5f});
-    glUniformMatrix4fv(Data::uniform_model_id, 1, GL_FALSE, glm::value_ptr(model));
-    Data::texture_list[1]->use();
-    Data::material_list[1]->use(Data::uniform_specular_intensity_id, Data::uniform_shininess_id);
-    Data::mesh_list[1]->render();
+    Data::draw_list->add(Data::mesh_list[1], Data::texture_list[1], Data::material_list[1], model, DrawList::STATIC);
 
     model = glm::mat4{1.f};
     model = glm::translate(model, glm::vec3{0.f, -2.f, 0.f});
-    glUniformMatrix4fv(Data::uniform_model_id, 1, GL_FALSE, glm::value_ptr(model));
-    Data::texture_list[1]->use();
-    Data::material_list[1]->use(Data::uniform_specular_intensity_id, Data::uniform_shininess_id);
-    Data::mesh_list[2]->render();
+    Data::draw_list->add(Data::mesh_list[2], Data::texture_list[1], Data::material_list[1], model, DrawList::OCCLUDER | DrawList::STATIC);
 
     model = glm::mat4{1.f};
     model = glm::translate(model, glm::vec3{-20.f, 0.f, 15.f});
     model = glm::scale(model, glm::vec3{0.01f, 0.01f, 0.01f});
-    glUniformMatrix4fv(Data::uniform_model_id, 1, GL_FALSE, glm::value_ptr(model));
-    Data::material_list[0]->use(Data::uniform_specular_intensity_id, Data::uniform_shininess_id);
-    Data::model_list[0]->render();
+    Data::draw_list->add(Data::model_list[0], Data::material_list[0], model, DrawList::OCCLUDER | DrawList::STATIC);
 
-    Data::black_hawk_angle += 0.1f;
+    Data::draw_list->add(Data::model_list[1], Data::material_list[0], Data::black_hawk_transform, DrawList::OCCLUDER);
+}
 
-	if (Data::black_hawk_angle > 360.0f)
-	{
-		Data::black_hawk_angle = 0.1f;
-	}
+// The pass's program must have taken the draw data unit with set_draw_data.
+// Depth-only passes skip the textures and draw the position streams.
+void render_scene(std::string_view pass, const DrawFilter& filter = nullptr, DrawList::Mode mode = DrawList::Mode::SHADED) noexcept
+{
+    Data::draw_list->read(GL_TEXTURE0 + Data::DRAW_DATA_TEXTURE_UNIT);
+    Data::draw_list->render(pass, filter, mode);
+}
 
-    model = glm::mat4(1.0f);
-	model = glm::rotate(model, to_radian(-Data::black_hawk_angle), glm::vec3(0.0f, 1.0f, 0.0f));
-	model = glm::translate(model, glm::vec3(-8.f, 2.f, 0.f));
-	model = glm::rotate(model, to_radian(-20.f), glm::vec3(0.f, 0.f, 1.f));
-	model = glm::rotate(model, to_radian(-90.f), glm::vec3(1.f, 0.f, 0.f));
-	model = glm::scale(model, glm::vec3(0.4f, 0.4f, 0.4f));
-	glUniformMatrix4fv(Data::uniform_model_id, 1, GL_FALSE, glm::value_ptr(model));
-	Data::material_list[0]->use(Data::uniform_specular_intensity_id, Data::uniform_shininess_id);
-    Data::model_list[1]->render();
+// Static items the camera's view cell cannot see, known without testing anything
+GLsizei potentially_visible(const BoundingBox&, size_t index) noexcept
+{
+    return !Data::pvs_enabled || Data::pvs->is_visible(index) ? 1 : 0;
+}
+
+GLsizei in_view(const BoundingBox& bounds, size_t index) noexcept
+{
+    if (!potentially_visible(bounds, index) || !Data::view_frustum.intersects(bounds))
+    {
+        return 0;
+    }
+
+    if (Data::camera_culling == CameraCulling::SOFTWARE_OCCLUSION && !Data::camera_occlusion->is_visible(bounds))
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+// Depth-only passes from the camera: the commands the GPU culling wrote
+// this frame, or the view frustum tested on the CPU without it
+void render_camera_depth(std::string_view pass) noexcept
+{
+    if (Data::camera_culling == CameraCulling::GPU)
+    {
+        Data::draw_list->read(GL_TEXTURE0 + Data::DRAW_DATA_TEXTURE_UNIT);
+        Data::draw_list->render_culled(pass, *Data::gpu_culling, in_view);
+    }
+    else
+    {
+        render_scene(pass, in_view, DrawList::Mode::DEPTH);
+    }
+}
+
+// Before the camera depth-only passes, against the depth of the last frame
+void gpu_culling_pass() noexcept
+{
+    Data::gpu_culling->update(*Data::draw_list, potentially_visible);
+    Data::gpu_culling->cull(Data::view_frustum, *Data::depth_pyramid, Data::pyramid_view_projection, Data::DEPTH_PYRAMID_TEXTURE_UNIT);
+}
+
+// This frame's depth for the next frame's occlusion culling: the G-buffer
+// depth on the deferred path, a copy of the window's depth otherwise (0)
+void build_depth_pyramid(const glm::mat4& view_projection, GLuint depth_id) noexcept
+{
+    if (depth_id != 0)
+    {
+        Data::depth_pyramid->build(depth_id);
+    }
+    else
+    {
+        Data::depth_pyramid->build_from_window();
+    }
+
+    Data::pyramid_view_projection = view_projection;
+    Data::depth_pyramid_built = true;
+}
+
+// The camera pass that fills the depth: with occlusion queries when they
+// are on, the view frustum alone otherwise. The shader must be in use.
+void render_camera_occluders(std::string_view pass, const Shader& shader, const glm::mat4& projection, const glm::mat4& view, DrawList::Mode mode) noexcept
+{
+    if (Data::camera_culling == CameraCulling::OCCLUSION_QUERIES)
+    {
+        Data::draw_list->read(GL_TEXTURE0 + Data::DRAW_DATA_TEXTURE_UNIT);
+        Data::occlusion_culling->render(pass, *Data::draw_list, mode, in_view, shader, projection, view, Data::camera->get_position());
+    }
+    else
+    {
+        render_scene(pass, in_view, mode);
+    }
+}
+
+std::string camera_culling_name(CameraCulling culling) noexcept
+{
+    switch (culling)
+    {
+        case CameraCulling::FRUSTUM:
+            return "view frustum";
+
+        case CameraCulling::SOFTWARE_OCCLUSION:
+            return "software occlusion";
+
+        case CameraCulling::OCCLUSION_QUERIES:
+            return "occlusion queries";
+
+        case CameraCulling::GPU:
+            return "GPU frustum and Hi-Z";
+    }
+
+    return "";
 }
 
 void directional_shadow_map_pass(std::shared_ptr<DirectionalLight> light) noexcept
 {
+    if (!light->get_shadow_map()->is_dirty())
+    {
+        return;
+    }
+
     Data::shader_list[1]->use();
     
     glViewport(0, 0, light->get_shadow_map()->get_width(), light->get_shadow_map()->get_height());
@@ -252,186 +557,1208 @@ void directional_shadow_map_pass(std::shared_ptr<DirectionalLight> light) noexce
 
     glClear(GL_DEPTH_BUFFER_BIT);
 
-    Data::uniform_model_id = Data::shader_list[1]->get_uniform_model_id();
-    Data::shader_list[1]->set_directional_light_space_transform(light->get_light_transform());
+    Data::shader_list[1]->set_draw_data(Data::DRAW_DATA_TEXTURE_UNIT);
+    Data::shader_list[1]->set_directional_light_space_transforms(light->get_light_transforms());
+
+    // Casters in front of a cascade's near plane are flattened onto it instead of clipped
+    glEnable(GL_DEPTH_CLAMP);
+
+    render_scene("Directional shadows", nullptr, DrawList::Mode::DEPTH);
+
+    glDisable(GL_DEPTH_CLAMP);
+
+    if (Data::shadow_filter_mode == ShadowFilter::Mode::FILTERED)
+    {
+        Data::shadow_filter->filter(*std::static_pointer_cast<CascadedShadowMap>(light->get_shadow_map()));
+    }
 
-    render_scene();
+    light->get_shadow_map()->mark_clean();
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void omnidirectional_shadow_map_pass(std::shared_ptr<PointLight> light) noexcept
+std::string omnidirectional_shadow_mode_name(OmnidirectionalShadowMap::Mode mode) noexcept
 {
-    glViewport(0, 0, light->get_shadow_map()->get_width(), light->get_shadow_map()->get_height());
+    switch (mode)
+    {
+        case OmnidirectionalShadowMap::Mode::GEOMETRY_SHADER:
+            return "geometry shader";
 
-    Data::shader_list[2]->use();
+        case OmnidirectionalShadowMap::Mode::PER_FACE:
+            return "per face";
 
-    Data::uniform_model_id = Data::shader_list[2]->get_uniform_model_id();
-    Data::uniform_omnidirectional_light_position_id = Data::shader_list[2]->get_uniform_omnidirectional_light_position_id();
-    Data::uniform_far_plane_id = Data::shader_list[2]->get_uniform_far_plane_id();
+        case OmnidirectionalShadowMap::Mode::VERTEX_LAYER:
+            return "vertex layer";
+    }
 
-    light->get_shadow_map()->write();
+    return "";
+}
 
-    glClear(GL_DEPTH_BUFFER_BIT);
+std::string depth_prepass_mode_name(DepthPrepassMode mode) noexcept
+{
+    switch (mode)
+    {
+        case DepthPrepassMode::AUTO:
+            return "automatic";
 
-    glUniform3f(Data::uniform_omnidirectional_light_position_id, light->get_position().x, light->get_position().y, light->get_position().z);
-    glUniform1f(Data::uniform_far_plane_id, light->get_far_plane());
-    Data::shader_list[2]->set_omnidirectional_light_matrices(light->get_light_transforms());
-    
-    render_scene();
+        case DepthPrepassMode::ALWAYS:
+            return "always";
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        case DepthPrepassMode::NEVER:
+            return "never";
+    }
+
+    return "";
 }
 
-void render_pass(const glm::mat4& projection, const glm::mat4& view) noexcept
+std::string pcf_mode_name(ShadowMap::PCFMode mode) noexcept
 {
-    glViewport(0, 0, Data::WIDTH, Data::HEIGHT);
+    switch (mode)
+    {
+        case ShadowMap::PCFMode::NONE:
+            return "no PCF";
 
-    // Clear the window
-    glClearColor(0.f, 0.f, 0.f, 1.f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        case ShadowMap::PCFMode::MANUAL_3X3:
+            return "manual 3x3 PCF";
 
-    Data::sky_box->render(view, projection);
+        case ShadowMap::PCFMode::HARDWARE_2X2:
+            return "hardware 2x2 PCF";
 
-    Data::shader_list[0]->use();
+        case ShadowMap::PCFMode::HARDWARE_POISSON:
+            return "hardware Poisson PCF";
+    }
 
-    Data::uniform_model_id = Data::shader_list[0]->get_uniform_model_id();
-    Data::uniform_projection_id = Data::shader_list[0]->get_uniform_projection_id();
-    Data::uniform_view_id = Data::shader_list[0]->get_uniform_view_id();
-    Data::uniform_eye_position_id = Data::shader_list[0]->get_uniform_eye_position_id();
-    Data::uniform_specular_intensity_id = Data::shader_list[0]->get_uniform_specular_intensity_id();
-    Data::uniform_shininess_id = Data::shader_list[0]->get_uniform_specular_shininess_id();
+    return "";
+}
 
-    glUniformMatrix4fv(Data::shader_list[0]->get_uniform_projection_id(), 1, GL_FALSE, glm::value_ptr(projection));
-    glUniformMatrix4fv(Data::shader_list[0]->get_uniform_view_id(), 1, GL_FALSE, glm::value_ptr(view));
-    glUniform3f(Data::shader_list[0]->get_uniform_eye_position_id(), Data::camera->get_position().x, Data::camera->get_position().y, Data::camera->get_position().z);
+std::shared_ptr<Shader> omnidirectional_shadow_shader(OmnidirectionalShadowMap::Mode mode) noexcept
+{
+    if (Data::omnidirectional_hardware_depth)
+    {
+        return Data::omnidirectional_depth_shaders[static_cast<size_t>(mode)];
+    }
 
-    Data::shader_list[0]->set_directional_light(Data::main_light);
-    Data::shader_list[0]->set_point_lights(Data::point_lights, 3, 0);
-    Data::shader_list[0]->set_spot_lights(Data::spot_lights, 3 + Data::point_lights.size(), Data::point_lights.size());
-    Data::shader_list[0]->set_directional_light_space_transform(Data::main_light->get_light_transform());
+    switch (mode)
+    {
+        case OmnidirectionalShadowMap::Mode::GEOMETRY_SHADER:
+            return Data::shader_list[2];
 
-    Data::main_light->get_shadow_map()->read(GL_TEXTURE2);
-    Data::shader_list[0]->set_texture(1);
-    Data::shader_list[0]->set_directional_shadow_map(2);
+        case OmnidirectionalShadowMap::Mode::PER_FACE:
+            return Data::shader_list[3];
 
-    auto lower_light = Data::camera->get_position();
-    lower_light.y -= 0.3f;
-    //Data::spot_lights[0]->set(lower_light, Data::camera->get_direction());
+        case OmnidirectionalShadowMap::Mode::VERTEX_LAYER:
+            return Data::shader_list[5];
+    }
 
-    render_scene();
+    return nullptr;
 }
 
-int main()
+void use_omnidirectional_shadow_shader(std::shared_ptr<Shader> shader, std::shared_ptr<PointLight> light, const LightTable::FaceTransforms& light_transforms) noexcept
 {
+    shader->use();
 
-    auto main_window = Window::create(Data::WIDTH, Data::HEIGHT, "Skybox");
+    shader->set_draw_data(Data::DRAW_DATA_TEXTURE_UNIT);
+    Data::uniform_omnidirectional_light_position_id = shader->get_uniform_omnidirectional_light_position_id();
+    Data::uniform_far_plane_id = shader->get_uniform_far_plane_id();
 
-    if (main_window == nullptr)
+    glUniform3f(Data::uniform_omnidirectional_light_position_id, light->get_position().x, light->get_position().y, light->get_position().z);
+    glUniform1f(Data::uniform_far_plane_id, light->get_far_plane());
+    shader->set_omnidirectional_light_matrices(light_transforms);
+    shader->set_omnidirectional_layer_offset(std::static_pointer_cast<OmnidirectionalShadowMap>(light->get_shadow_map())->get_layer_offset());
+}
+
+std::array<Frustum, OmnidirectionalShadowMap::NUM_FACES> omnidirectional_face_frustums(const LightTable::FaceTransforms& light_transforms) noexcept
+{
+    std::array<Frustum, OmnidirectionalShadowMap::NUM_FACES> face_frustums;
+
+    for (size_t face = 0; face < OmnidirectionalShadowMap::NUM_FACES; ++face)
     {
-        return EXIT_FAILURE;
+        face_frustums[face] = Frustum{light_transforms[face]};
     }
 
-    specify_vertices();
-    create_shaders_program();
-    create_textures_and_materials();
-
-    auto xwing = std::make_shared<Model>(Data::root_path);
-    xwing->load("x-wing.obj");
-    Data::model_list.push_back(xwing);
+    return face_frustums;
+}
 
-    auto black_hawk = std::make_shared<Model>(Data::root_path);
-    black_hawk->load("uh60.obj");
-    Data::model_list.push_back(black_hawk);
+// Bit f set for every cube face f the bounds overlap, none out of the light's reach
+GLuint omnidirectional_face_mask(const PointLight& light, const std::array<Frustum, OmnidirectionalShadowMap::NUM_FACES>& face_frustums, const BoundingBox& bounds) noexcept
+{
+    if (!light.shadow_volume_intersects(bounds))
+    {
+        return 0;
+    }
 
-    Data::camera = std::make_shared<Camera>(glm::vec3{-3.f, 2.f, 3.f}, glm::vec3{0.f, 1.f, 0.f}, 0.f, -60.f, 5.f, 20.0f);
+    GLuint mask = 0;
 
-    Data::main_light = std::make_shared<DirectionalLight>(
-        1024, 1024,         // shadow map size
-        1.f, 0.5f, 0.3f,    // color
-        0.1f, 0.6f,         // ambient and diffuse intensity
-        -8.f, -10.f, 14.f   //direction
-    );
+    for (size_t face = 0; face < OmnidirectionalShadowMap::NUM_FACES; ++face)
+    {
+        if (face_frustums[face].intersects(bounds))
+        {
+            mask |= 1u << face;
+        }
+    }
 
-    /*Data::point_lights.push_back(
-        std::make_shared<PointLight>(
-            1024, 1024,        // shadow map size
-            0.1f, 100.f,       // near and far
-            0.f, 0.f, 1.f,     // color
-            0.f, 0.4f,         // ambient and diffuse intensity
-            4.f, 0.f, 0.f,     // position
-            0.01f, 0.01f, 0.3f // a, b, c
-        )
-    );
-    Data::point_lights.push_back(
-        std::make_shared<PointLight>(
-            1024, 1024,        // shadow map size
-            0.1f, 100.f,       // near and far
-            0.f, 1.f, 0.f,     // color
-            0.f, 0.4f,         // ambient and diffuse intensity
-            -4.f, 2.f, 0.f,    // position
-            0.01f, 0.01f, 0.3f // a, b, c
-        )
-    );*/
+    return mask;
+}
 
-    /*Data::spot_lights.push_back(
-        std::make_shared<SpotLight>(
-            1024, 1024,      // shadow map size
-            0.1f, 100.f,     // near and far
-            1.f, 1.f, 1.f,   // color
-            0.f, 2.f,        // ambient and diffuse intensity
-            0.f, 3.f, -5.f,  // position
-            0.f, 0.f, 1.f,   // a, b, c
-            0.f, -1.f, 0.f,  // direction
-            20.f             // edge
-        )
-    );*/
+GLsizei count_faces(GLuint face_mask) noexcept
+{
+    GLsizei num_faces = 0;
 
-    Data::sky_box = std::make_shared<SkyBox>(
-        Data::root_path,
-        std::vector<fs::path>{{
-            "cupertin-lake_rt.tga",
-            "cupertin-lake_lf.tga",
-            "cupertin-lake_up.tga",
-            "cupertin-lake_dn.tga",
-            "cupertin-lake_bk.tga",
-            "cupertin-lake_ft.tga",
-        }}
-    );
+    for (; face_mask != 0; face_mask &= face_mask - 1)
+    {
+        ++num_faces;
+    }
 
-    glm::mat4 projection = glm::perspective(glm::radians(60.f), main_window->get_aspect_ratio(), 0.1f, 100.f);
+    return num_faces;
+}
 
-    GLfloat last_time = glfwGetTime();
-    
-    while (!main_window->should_be_closed())
+// Cube faces the light's shadow pass draws into. The geometry shader sends
+// every triangle to all six, the other modes only touch the faces holding a
+// caster and clear the rest.
+GLuint omnidirectional_shadow_faces(std::shared_ptr<PointLight> light) noexcept
+{
+    if (Data::omnidirectional_shadow_mode == OmnidirectionalShadowMap::Mode::GEOMETRY_SHADER)
     {
-        GLfloat now = glfwGetTime();
-        GLfloat dt = now - last_time;
-        last_time = now;
+        return OmnidirectionalShadowMap::NUM_FACES;
+    }
 
-        // Get and handle user input events
-        glfwPollEvents();
+    GLint index = Data::light_table->find(light.get());
 
-        Data::camera->handle_keys(main_window->get_keys());
-        Data::camera->handle_mouse(main_window->get_x_change(), main_window->get_y_change());
-        Data::camera->update(dt);
+    if (index < 0)
+    {
+        return 0;
+    }
 
-        directional_shadow_map_pass(Data::main_light);  
+    auto face_frustums = omnidirectional_face_frustums(Data::light_table->get_point_light_transforms(index));
+    const GLuint all_faces = (1u << OmnidirectionalShadowMap::NUM_FACES) - 1;
+    GLuint face_mask = 0;
 
-        for (auto light: Data::point_lights)
+    for (const auto& item: Data::draw_list->get_items())
+    {
+        face_mask |= omnidirectional_face_mask(*light, face_frustums, item.bounds);
+
+        if (face_mask == all_faces)
         {
-            omnidirectional_shadow_map_pass(light);
+            break;
         }
+    }
 
-        for (auto light: Data::spot_lights)
+    return count_faces(face_mask);
+}
+
+void omnidirectional_shadow_map_pass(std::shared_ptr<PointLight> light) noexcept
+{
+    if (!light->get_shadow_map()->is_dirty())
+    {
+        return;
+    }
+
+    GLint index = Data::light_table->find(light.get());
+
+    if (index < 0)
+    {
+        return;
+    }
+
+    auto shadow_map = std::static_pointer_cast<OmnidirectionalShadowMap>(light->get_shadow_map());
+    const auto& light_transforms = Data::light_table->get_point_light_transforms(index);
+    auto face_frustums = omnidirectional_face_frustums(light_transforms);
+
+    glViewport(0, 0, shadow_map->get_width(), shadow_map->get_height());
+
+    auto shader = omnidirectional_shadow_shader(Data::omnidirectional_shadow_mode);
+
+    switch (Data::omnidirectional_shadow_mode)
+    {
+        case OmnidirectionalShadowMap::Mode::GEOMETRY_SHADER:
         {
-            omnidirectional_shadow_map_pass(light);
-        }
+            use_omnidirectional_shadow_shader(shader, light, light_transforms);
 
-        render_pass(projection, Data::camera->get_view_matrix());
+            shadow_map->clear();
+            shadow_map->write();
+
+            // Objects out of the light's reach cannot cast into the cube map
+            render_scene("Omnidirectional shadows", [&light](const BoundingBox& bounds, size_t) { return light->shadow_volume_intersects(bounds) ? 1 : 0; }, DrawList::Mode::DEPTH);
+            break;
+        }
+
+        case OmnidirectionalShadowMap::Mode::PER_FACE:
+        {
+            use_omnidirectional_shadow_shader(shader, light, light_transforms);
+
+            for (size_t face = 0; face < OmnidirectionalShadowMap::NUM_FACES; ++face)
+            {
+                shadow_map->write_face(face);
+                glClear(GL_DEPTH_BUFFER_BIT);
+
+                shader->set_omnidirectional_face(face);
+
+                render_scene("Omnidirectional shadows", [&face_frustums, face](const BoundingBox& bounds, size_t) { return face_frustums[face].intersects(bounds) ? 1 : 0; }, DrawList::Mode::DEPTH);
+            }
+            break;
+        }
+
+        case OmnidirectionalShadowMap::Mode::VERTEX_LAYER:
+        {
+            use_omnidirectional_shadow_shader(shader, light, light_transforms);
+
+            // The draw data carries the faces of every item, so the items still go out batched.
+            // Each light takes a buffer of the ring; GL keeps earlier draws on the data they were issued with.
+            const auto& items = Data::draw_list->get_items();
+            std::vector<GLuint> face_masks(items.size());
+
+            for (size_t i = 0; i < items.size(); ++i)
+            {
+                face_masks[i] = omnidirectional_face_mask(*light, face_frustums, items[i].bounds);
+            }
+
+            Data::draw_list->upload(face_masks);
+
+            shadow_map->clear();
+            shadow_map->write();
+
+            // One instance per face an object overlaps
+            render_scene("Omnidirectional shadows", [&face_masks](const BoundingBox&, size_t i) { return count_faces(face_masks[i]); }, DrawList::Mode::DEPTH);
+            break;
+        }
+    }
+
+    if (Data::shadow_filter_mode == ShadowFilter::Mode::FILTERED)
+    {
+        Data::shadow_filter->filter(*shadow_map, Data::omnidirectional_hardware_depth, light->get_near_plane(), light->get_far_plane());
+    }
+
+    light->get_shadow_map()->mark_clean();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Fraction of the screen height covered by a sphere, 0 when it is out of view
+GLfloat screen_coverage(const glm::vec3& center, GLfloat radius, const Frustum& view_frustum) noexcept
+{
+    BoundingBox bounds;
+    bounds.expand(center - glm::vec3{radius});
+    bounds.expand(center + glm::vec3{radius});
+
+    if (radius <= 0.f || !view_frustum.intersects(bounds))
+    {
+        return 0.f;
+    }
+
+    GLfloat distance = glm::length(center - Data::camera->get_position());
+
+    if (distance <= radius)
+    {
+        return 1.f;
+    }
+
+    GLfloat projected_radius = std::tan(std::asin(radius / distance)) / std::tan(glm::radians(Data::FIELD_OF_VIEW) / 2.f);
+
+    return std::min(1.f, projected_radius);
+}
+
+void allocate_shadow_atlas(const glm::mat4& projection, const glm::mat4& view, GLuint screen_height) noexcept
+{
+    Frustum view_frustum{projection * view};
+
+    std::vector<GLuint> requested_sizes;
+    requested_sizes.reserve(Data::spot_lights.size());
+
+    for (size_t i = 0; i < Data::spot_lights.size(); ++i)
+    {
+        GLfloat range = Data::light_table->get_range(Data::light_table->get_spot_light_index(i));
+        GLfloat coverage = screen_coverage(Data::spot_lights[i]->get_position(), range, view_frustum);
+        requested_sizes.push_back(Data::shadow_atlas->get_tile_size(coverage, screen_height));
+    }
+
+    auto tiles = Data::shadow_atlas->allocate(requested_sizes);
+
+    for (size_t i = 0; i < Data::spot_lights.size(); ++i)
+    {
+        std::static_pointer_cast<AtlasShadowMap>(Data::spot_lights[i]->get_shadow_map())->set_tile(tiles[i]);
+    }
+}
+
+std::vector<std::shared_ptr<PointLight>> schedule_omnidirectional_shadow_maps(const glm::mat4& projection, const glm::mat4& view) noexcept
+{
+    Frustum view_frustum{projection * view};
+
+    std::vector<GLfloat> coverages;
+    coverages.reserve(Data::point_lights.size());
+
+    for (size_t i = 0; i < Data::point_lights.size(); ++i)
+    {
+        coverages.push_back(screen_coverage(Data::point_lights[i]->get_position(), Data::light_table->get_range(i), view_frustum));
+    }
+
+    return Data::shadow_scheduler->schedule(Data::point_lights, coverages, [](size_t i) { return omnidirectional_shadow_faces(Data::point_lights[i]); });
+}
+
+void spot_shadow_map_pass(std::shared_ptr<SpotLight> light, const glm::mat4& light_transform) noexcept
+{
+    auto shadow_map = std::static_pointer_cast<AtlasShadowMap>(light->get_shadow_map());
+
+    if (!shadow_map->is_dirty() || !shadow_map->has_tile())
+    {
+        return;
+    }
+
+    Data::shader_list[4]->use();
+
+    Data::shader_list[4]->set_draw_data(Data::DRAW_DATA_TEXTURE_UNIT);
+
+    // Sets viewport and scissor to the light's tile, so the clear keeps the other tiles
+    shadow_map->write();
+
+    glEnable(GL_SCISSOR_TEST);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    Data::shader_list[4]->set_light_space_transform(light_transform);
+
+    Frustum frustum{light_transform};
+    bool occlusion = Data::camera_culling == CameraCulling::SOFTWARE_OCCLUSION;
+
+    // Casters hidden from the light behind the occluders leave no depth in its map
+    if (occlusion)
+    {
+        Data::shadow_occlusion->render(*Data::draw_list, light_transform);
+    }
+
+    render_scene("Spot shadows", [&frustum, occlusion](const BoundingBox& bounds, size_t) {
+        return frustum.intersects(bounds) && (!occlusion || Data::shadow_occlusion->is_visible(bounds)) ? 1 : 0;
+    }, DrawList::Mode::DEPTH);
+
+    glDisable(GL_SCISSOR_TEST);
+
+    shadow_map->mark_clean();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void handle_render_options(const std::array<bool, 1024>& keys) noexcept
+{
+    LOG_INIT_COUT();
+
+    // O cycles the omnidirectional shadow rendering path
+    if (keys[GLFW_KEY_O] && !Data::previous_keys[GLFW_KEY_O])
+    {
+        switch (Data::omnidirectional_shadow_mode)
+        {
+            case OmnidirectionalShadowMap::Mode::GEOMETRY_SHADER:
+                Data::omnidirectional_shadow_mode = OmnidirectionalShadowMap::Mode::PER_FACE;
+                break;
+
+            case OmnidirectionalShadowMap::Mode::PER_FACE:
+                Data::omnidirectional_shadow_mode = Data::vertex_layer_supported ? OmnidirectionalShadowMap::Mode::VERTEX_LAYER : OmnidirectionalShadowMap::Mode::GEOMETRY_SHADER;
+                break;
+
+            case OmnidirectionalShadowMap::Mode::VERTEX_LAYER:
+                Data::omnidirectional_shadow_mode = OmnidirectionalShadowMap::Mode::GEOMETRY_SHADER;
+                break;
+        }
+
+        std::string name = omnidirectional_shadow_mode_name(Data::omnidirectional_shadow_mode) + (Data::omnidirectional_hardware_depth ? ", hardware depth" : "");
+        log(LOG_INFO) << "Omnidirectional shadows: " << name << "\n";
+        Data::omnidirectional_shadow_timer->reset("Omnidirectional shadows (" + name + ")");
+
+        // Re-render every cube so the timer measures the new path
+        for (auto light: Data::point_lights)
+        {
+            light->get_shadow_map()->mark_dirty();
+        }
+    }
+
+    // L switches the cubes between linear distance and hardware depth
+    if (keys[GLFW_KEY_L] && !Data::previous_keys[GLFW_KEY_L])
+    {
+        Data::omnidirectional_hardware_depth = !Data::omnidirectional_hardware_depth;
+
+        std::string name = omnidirectional_shadow_mode_name(Data::omnidirectional_shadow_mode) + (Data::omnidirectional_hardware_depth ? ", hardware depth" : "");
+        log(LOG_INFO) << "Omnidirectional shadow depth: " << (Data::omnidirectional_hardware_depth ? "hardware" : "linear") << "\n";
+        Data::omnidirectional_shadow_timer->reset("Omnidirectional shadows (" + name + ")");
+
+        for (auto light: Data::point_lights)
+        {
+            light->get_shadow_map()->mark_dirty();
+        }
+    }
+
+    // F switches between PCF and prefiltered (EVSM/ESM) shadows
+    if (keys[GLFW_KEY_F] && !Data::previous_keys[GLFW_KEY_F])
+    {
+        Data::shadow_filter_mode = Data::shadow_filter_mode == ShadowFilter::Mode::PCF ? ShadowFilter::Mode::FILTERED : ShadowFilter::Mode::PCF;
+        log(LOG_INFO) << "Shadow filtering: " << (Data::shadow_filter_mode == ShadowFilter::Mode::PCF ? "PCF" : "EVSM/ESM") << "\n";
+
+        // The moments are only built when a shadow map is rendered
+        Data::main_light->get_shadow_map()->mark_dirty();
+
+        for (auto light: Data::point_lights)
+        {
+            light->get_shadow_map()->mark_dirty();
+        }
+    }
+
+    // P cycles the PCF mode of the directional and spot shadows
+    if (keys[GLFW_KEY_P] && !Data::previous_keys[GLFW_KEY_P])
+    {
+        Data::pcf_mode = static_cast<ShadowMap::PCFMode>((static_cast<int>(Data::pcf_mode) + 1) % 4);
+
+        std::string name = pcf_mode_name(Data::pcf_mode);
+        log(LOG_INFO) << "Shadow PCF: " << name << "\n";
+        Data::lighting_timer->reset("Lighting (" + name + ")");
+    }
+
+    // M cycles the screen-space shadow mask: off, half and quarter resolution
+    if (keys[GLFW_KEY_M] && !Data::previous_keys[GLFW_KEY_M])
+    {
+        if (!Data::shadow_mask_enabled)
+        {
+            Data::shadow_mask_enabled = Data::shadow_mask->set_resolution(ShadowMask::Resolution::HALF);
+        }
+        else if (Data::shadow_mask->get_resolution() == ShadowMask::Resolution::HALF)
+        {
+            Data::shadow_mask_enabled = Data::shadow_mask->set_resolution(ShadowMask::Resolution::QUARTER);
+        }
+        else
+        {
+            Data::shadow_mask_enabled = false;
+        }
+
+        std::string name = !Data::shadow_mask_enabled ? "off" : Data::shadow_mask->get_resolution() == ShadowMask::Resolution::HALF ? "half resolution" : "quarter resolution";
+        log(LOG_INFO) << "Shadow mask: " << name << "\n";
+        Data::lighting_timer->reset("Lighting (" + pcf_mode_name(Data::pcf_mode) + ", shadow mask " + name + ")");
+    }
+
+    // G switches between forward and deferred shading
+    if (keys[GLFW_KEY_G] && !Data::previous_keys[GLFW_KEY_G])
+    {
+        Data::deferred_shading = !Data::deferred_shading;
+
+        std::string name = Data::deferred_shading ? "deferred" : "forward";
+        log(LOG_INFO) << "Shading: " << name << "\n";
+        Data::lighting_timer->reset("Lighting (" + name + ")");
+    }
+
+    // Z cycles the forward depth prepass: automatic, always and never
+    if (keys[GLFW_KEY_Z] && !Data::previous_keys[GLFW_KEY_Z])
+    {
+        Data::depth_prepass_mode = static_cast<DepthPrepassMode>((static_cast<int>(Data::depth_prepass_mode) + 1) % 3);
+
+        log(LOG_INFO) << "Depth prepass: " << depth_prepass_mode_name(Data::depth_prepass_mode) << "\n";
+    }
+
+    // C cycles the culling of the camera passes: view frustum, software occlusion, occlusion queries and, from GL 4.3, GPU culling
+    if (keys[GLFW_KEY_C] && !Data::previous_keys[GLFW_KEY_C])
+    {
+        int num_modes = Data::gpu_culling ? 4 : 3;
+        Data::camera_culling = static_cast<CameraCulling>((static_cast<int>(Data::camera_culling) + 1) % num_modes);
+
+        if (Data::camera_culling == CameraCulling::GPU)
+        {
+            // Whatever the pyramid holds is from before the switch
+            Data::depth_pyramid->invalidate();
+        }
+
+        log(LOG_INFO) << "Camera culling: " << camera_culling_name(Data::camera_culling) << "\n";
+    }
+
+    // V toggles the baked potentially visible sets of the camera passes
+    if (keys[GLFW_KEY_V] && !Data::previous_keys[GLFW_KEY_V] && Data::pvs->is_baked())
+    {
+        Data::pvs_enabled = !Data::pvs_enabled;
+
+        log(LOG_INFO) << "Potentially visible sets: " << (Data::pvs_enabled ? "on" : "off") << "\n";
+    }
+
+    // H shows how many omnidirectional PCF samples each pixel took
+    if (keys[GLFW_KEY_H] && !Data::previous_keys[GLFW_KEY_H])
+    {
+        Data::show_shadow_samples = !Data::show_shadow_samples;
+    }
+
+    Data::previous_keys = keys;
+}
+
+// Directional and point light shadows, shared by the lighting and shadow mask programs
+void set_shadow_uniforms(std::shared_ptr<Shader> shader) noexcept
+{
+    shader->set_directional_light(Data::main_light);
+    shader->set_point_lights(Data::point_lights, 3);
+    shader->set_directional_light_space_transforms(Data::main_light->get_light_transforms());
+    shader->set_cascade_splits(Data::main_light->get_cascade_splits());
+
+    Data::main_light->get_shadow_map()->read(GL_TEXTURE2);
+    shader->set_directional_shadow_map(2);
+
+    shader->set_shadow_filter_mode(static_cast<GLint>(Data::shadow_filter_mode));
+    shader->set_pcf_mode(static_cast<GLint>(Data::pcf_mode));
+    shader->set_omnidirectional_hardware_depth(Data::omnidirectional_hardware_depth);
+
+    // The same depth textures again, through comparison samplers
+    Data::main_light->get_shadow_map()->read_comparison(GL_TEXTURE7);
+    shader->set_directional_shadow_comparison(7);
+
+    shader->set_directional_moments(5);
+    shader->set_omnidirectional_moments(6);
+
+    if (Data::shadow_filter_mode == ShadowFilter::Mode::FILTERED)
+    {
+        std::static_pointer_cast<CascadedShadowMap>(Data::main_light->get_shadow_map())->read_moments(GL_TEXTURE5);
+
+        if (!Data::point_lights.empty())
+        {
+            std::static_pointer_cast<OmnidirectionalShadowMap>(Data::point_lights[0]->get_shadow_map())->read_moments(GL_TEXTURE6);
+        }
+    }
+}
+
+// Depth prepass, then the shadows of every visible pixel into the reduced-resolution mask
+// Into the full resolution depth target the frame graph bound, when no prepass left one
+void shadow_mask_depth_pass(const glm::mat4& projection, const glm::mat4& view) noexcept
+{
+    Data::depth_prepass_shader->use();
+
+    Data::depth_prepass_shader->set_draw_data(Data::DRAW_DATA_TEXTURE_UNIT);
+    glUniformMatrix4fv(Data::depth_prepass_shader->get_uniform_projection_id(), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniformMatrix4fv(Data::depth_prepass_shader->get_uniform_view_id(), 1, GL_FALSE, glm::value_ptr(view));
+
+    glClear(GL_DEPTH_BUFFER_BIT);
+    render_camera_depth("Shadow mask depth");
+}
+
+void shadow_mask_pass(const glm::mat4& projection, const glm::mat4& view, GLuint depth_id) noexcept
+{
+    auto mask_shader = Data::shader_list[6];
+    mask_shader->use();
+
+    glUniform3f(mask_shader->get_uniform_eye_position_id(), Data::camera->get_position().x, Data::camera->get_position().y, Data::camera->get_position().z);
+    set_shadow_uniforms(mask_shader);
+
+    Data::shadow_mask->evaluate(projection, view, depth_id, 9);
+}
+
+// Everything lighting.glsl reads, shared by the forward and the deferred lighting programs
+void set_lighting_uniforms(std::shared_ptr<Shader> shader) noexcept
+{
+    glUniform3f(shader->get_uniform_eye_position_id(), Data::camera->get_position().x, Data::camera->get_position().y, Data::camera->get_position().z);
+
+    set_shadow_uniforms(shader);
+    shader->set_spot_lights(Data::spot_lights, *Data::light_table, 4);
+    shader->set_show_shadow_samples(Data::show_shadow_samples);
+
+    shader->set_spot_shadow_comparison(8);
+
+    if (!Data::spot_lights.empty())
+    {
+        Data::spot_lights[0]->get_shadow_map()->read_comparison(GL_TEXTURE8);
+    }
+
+    if (Data::shadow_mask_enabled)
+    {
+        Data::shadow_mask->read(GL_TEXTURE10, GL_TEXTURE11);
+    }
+
+    shader->set_shadow_mask(Data::shadow_mask_enabled, 10, 11, Data::shadow_mask->get_scale());
+
+    Data::light_clusters->read(GL_TEXTURE12, GL_TEXTURE13, GL_TEXTURE14);
+    shader->set_light_clusters(12, 13, 14, Data::light_clusters->get_num_point_lights(),
+                               glm::vec2{float(LightClusters::CLUSTERS_X) / Data::WIDTH, float(LightClusters::CLUSTERS_Y) / Data::HEIGHT},
+                               Data::light_clusters->get_depth_slicing());
+}
+
+// Deferred path, first half: material and normal of the visible surfaces
+// into the G-buffer, which the frame graph bound
+void geometry_pass(const glm::mat4& projection, const glm::mat4& view) noexcept
+{
+    auto shader = Data::shader_list[7];
+    shader->use();
+
+    shader->set_draw_data(Data::DRAW_DATA_TEXTURE_UNIT);
+
+    glUniformMatrix4fv(shader->get_uniform_projection_id(), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniformMatrix4fv(shader->get_uniform_view_id(), 1, GL_FALSE, glm::value_ptr(view));
+    shader->set_texture(1);
+
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    render_camera_occluders("G-buffer", *shader, projection, view, DrawList::Mode::SHADED);
+}
+
+// Deferred path, second half: one fullscreen pass over the G-buffer. The
+// directional light covers every pixel and the point and spot lights come
+// from each pixel's cluster, so the cost follows their screen coverage.
+void deferred_lighting_pass(const glm::mat4& projection, const glm::mat4& view, const FrameGraph& graph, const GBuffer& gbuffer) noexcept
+{
+    glViewport(0, 0, Data::WIDTH, Data::HEIGHT);
+
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    Data::sky_box->render(view, projection);
+
+    auto shader = Data::shader_list[8];
+    shader->use();
+
+    glUniformMatrix4fv(shader->get_uniform_view_id(), 1, GL_FALSE, glm::value_ptr(view));
+    set_lighting_uniforms(shader);
+
+    // Units 0, 1 and 9 hold nothing else during this pass
+    gbuffer.read(graph, GL_TEXTURE0, GL_TEXTURE1, GL_TEXTURE9);
+    shader->set_gbuffer(0, 1, 9, glm::inverse(projection * view));
+
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(Data::fullscreen_VAO_id);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+}
+
+// The overdraw is measured on whichever pass runs the real depth test, so
+// it means the same with and without the prepass and the hysteresis holds
+void update_depth_prepass() noexcept
+{
+    bool enabled = Data::depth_prepass;
+
+    switch (Data::depth_prepass_mode)
+    {
+        case DepthPrepassMode::ALWAYS:
+            enabled = true;
+            break;
+
+        case DepthPrepassMode::NEVER:
+            enabled = false;
+            break;
+
+        case DepthPrepassMode::AUTO:
+        {
+            double overdraw = Data::overdraw_counter->get_overdraw();
+
+            if (!Data::depth_prepass && overdraw > Data::DEPTH_PREPASS_ENABLE_OVERDRAW)
+            {
+                enabled = true;
+            }
+            else if (Data::depth_prepass && overdraw > 0.0 && overdraw < Data::DEPTH_PREPASS_DISABLE_OVERDRAW)
+            {
+                enabled = false;
+            }
+
+            break;
+        }
+    }
+
+    if (enabled != Data::depth_prepass)
+    {
+        Data::depth_prepass = enabled;
+
+        LOG_INIT_COUT();
+        log(LOG_INFO) << "Depth prepass " << (enabled ? "on" : "off") << " (overdraw " << Data::overdraw_counter->get_overdraw() << ")\n";
+    }
+}
+
+// Depth only, so the lighting shader afterwards runs once per visible pixel.
+// Into the camera depth target the frame graph bound, which the shadow mask
+// reads and the forward pass tests against.
+void depth_prepass(const glm::mat4& projection, const glm::mat4& view) noexcept
+{
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    Data::depth_prepass_shader->use();
+
+    Data::depth_prepass_shader->set_draw_data(Data::DRAW_DATA_TEXTURE_UNIT);
+    glUniformMatrix4fv(Data::depth_prepass_shader->get_uniform_projection_id(), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniformMatrix4fv(Data::depth_prepass_shader->get_uniform_view_id(), 1, GL_FALSE, glm::value_ptr(view));
+
+    if (Data::camera_culling == CameraCulling::OCCLUSION_QUERIES)
+    {
+        // One call per item, each inside its query
+        render_camera_occluders("Depth prepass", *Data::depth_prepass_shader, projection, view, DrawList::Mode::DEPTH_UNBATCHED);
+    }
+    else
+    {
+        render_camera_depth("Depth prepass");
+    }
+}
+
+// With the prepass on, camera_depth is the depth it wrote
+void render_pass(const glm::mat4& projection, const glm::mat4& view, FrameGraph& graph, FrameGraph::Resource camera_depth) noexcept
+{
+    glViewport(0, 0, Data::WIDTH, Data::HEIGHT);
+
+    // Clear the window
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    Data::sky_box->render(view, projection);
+
+    if (Data::depth_prepass)
+    {
+        graph.copy_depth(camera_depth, 0);
+
+        // Both vertex shaders compute an invariant gl_Position, so equal depths match exactly
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+    }
+
+    Data::shader_list[0]->use();
+
+    Data::shader_list[0]->set_draw_data(Data::DRAW_DATA_TEXTURE_UNIT);
+    Data::uniform_projection_id = Data::shader_list[0]->get_uniform_projection_id();
+    Data::uniform_view_id = Data::shader_list[0]->get_uniform_view_id();
+    Data::uniform_eye_position_id = Data::shader_list[0]->get_uniform_eye_position_id();
+
+    glUniformMatrix4fv(Data::shader_list[0]->get_uniform_projection_id(), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniformMatrix4fv(Data::shader_list[0]->get_uniform_view_id(), 1, GL_FALSE, glm::value_ptr(view));
+    set_lighting_uniforms(Data::shader_list[0]);
+    Data::shader_list[0]->set_texture(1);
+
+    if (Data::depth_prepass)
+    {
+        if (Data::camera_culling == CameraCulling::OCCLUSION_QUERIES)
+        {
+            // The prepass queries already tell which items left a fragment in the depth
+            Data::draw_list->read(GL_TEXTURE0 + Data::DRAW_DATA_TEXTURE_UNIT);
+            Data::occlusion_culling->render_conditional("Forward", *Data::draw_list, DrawList::Mode::SHADED);
+        }
+        else
+        {
+            render_scene("Forward", in_view);
+        }
+
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+    }
+    else
+    {
+        Data::overdraw_counter->begin();
+        render_camera_occluders("Forward", *Data::shader_list[0], projection, view, DrawList::Mode::SHADED);
+        Data::overdraw_counter->end(Data::WIDTH, Data::HEIGHT);
+    }
+}
+
+// Every pass of the frame, run in the order they are added. The shadow mask,
+// geometry and GPU culling passes are declared whatever the options, and the
+// graph drops them when no pass that runs reads what they write.
+void build_frame_graph(const glm::mat4& projection, const glm::mat4& view, const glm::mat4& view_projection, GLuint screen_height) noexcept
+{
+    FrameGraph& graph = *Data::frame_graph;
+
+    // Cached across frames, so their owners keep them
+    FrameGraph::Resource window = graph.import_resource("Window", 0);
+    FrameGraph::Resource directional_shadows = graph.import_resource("Directional shadow map");
+    FrameGraph::Resource omnidirectional_shadows = graph.import_resource("Omnidirectional shadow maps");
+    FrameGraph::Resource spot_shadows = graph.import_resource("Spot shadow atlas");
+    FrameGraph::Resource shadow_mask = graph.import_resource("Shadow mask");
+    FrameGraph::Resource depth_pyramid = graph.import_resource("Depth pyramid");
+    FrameGraph::Resource culled_draws = graph.import_resource("Culled draws");
+
+    graph.add_pass("Directional shadows",
+        [&](FrameGraph::Builder& builder) { builder.write(directional_shadows); },
+        [](FrameGraph&) { directional_shadow_map_pass(Data::main_light); });
+
+    graph.add_pass("Omnidirectional shadows",
+        [&](FrameGraph::Builder& builder) { builder.write(omnidirectional_shadows); },
+        [projection, view](FrameGraph&) {
+            auto scheduled_point_lights = schedule_omnidirectional_shadow_maps(projection, view);
+
+            Data::omnidirectional_shadow_timer->begin();
+
+            for (auto light: scheduled_point_lights)
+            {
+                omnidirectional_shadow_map_pass(light);
+            }
+
+            if (Data::shadow_filter_mode == ShadowFilter::Mode::FILTERED)
+            {
+                Data::shadow_filter->generate_omnidirectional_mipmaps();
+            }
+
+            Data::omnidirectional_shadow_timer->end();
+        });
+
+    graph.add_pass("Spot shadows",
+        [&](FrameGraph::Builder& builder) { builder.write(spot_shadows); },
+        [projection, view, screen_height](FrameGraph&) {
+            allocate_shadow_atlas(projection, view, screen_height);
+
+            for (size_t i = 0; i < Data::spot_lights.size(); ++i)
+            {
+                spot_shadow_map_pass(Data::spot_lights[i], Data::light_table->get_spot_light_transform(i));
+            }
+        });
+
+    // Only the camera depth-only passes draw the commands it writes, so it is
+    // dropped, together with the pyramid it reads, when neither of them runs
+    bool gpu_culling = Data::camera_culling == CameraCulling::GPU;
+
+    if (gpu_culling)
+    {
+        graph.add_pass("GPU culling",
+            [&](FrameGraph::Builder& builder) {
+                builder.read(depth_pyramid);
+                builder.write(culled_draws);
+            },
+            [](FrameGraph&) { gpu_culling_pass(); });
+    }
+
+    // The camera depth of the forward prepass, or one of the shadow mask's own. Ahead
+    // of the geometry pass, so the G-buffer depth can reuse the latter's texture.
+    bool prepass = !Data::deferred_shading && Data::depth_prepass;
+    FrameGraph::Resource camera_depth{0};
+
+    if (prepass)
+    {
+        // D24S8 like the window, which the forward pass copies it into
+        graph.add_pass("Depth prepass",
+            [&](FrameGraph::Builder& builder) {
+                camera_depth = builder.create("Camera depth", {Data::WIDTH, Data::HEIGHT, GL_DEPTH24_STENCIL8});
+
+                if (gpu_culling)
+                {
+                    builder.read(culled_draws);
+                }
+            },
+            [projection, view](FrameGraph&) {
+                Data::overdraw_counter->begin();
+                depth_prepass(projection, view);
+                Data::overdraw_counter->end(Data::WIDTH, Data::HEIGHT);
+            });
+    }
+    else
+    {
+        graph.add_pass("Shadow mask depth",
+            [&](FrameGraph::Builder& builder) {
+                camera_depth = builder.create("Shadow mask depth", {Data::WIDTH, Data::HEIGHT, GL_DEPTH_COMPONENT24});
+
+                if (gpu_culling)
+                {
+                    builder.read(culled_draws);
+                }
+            },
+            [projection, view](FrameGraph&) { shadow_mask_depth_pass(projection, view); });
+    }
+
+    graph.add_pass("Shadow mask",
+        [&](FrameGraph::Builder& builder) {
+            builder.read(camera_depth);
+            builder.read(directional_shadows);
+            builder.read(omnidirectional_shadows);
+            builder.write(shadow_mask);
+        },
+        [projection, view, camera_depth](FrameGraph& graph) { shadow_mask_pass(projection, view, graph.get_texture(camera_depth)); });
+
+    GBuffer gbuffer;
+
+    graph.add_pass("Geometry",
+        [&](FrameGraph::Builder& builder) { gbuffer = GBuffer::create(builder, Data::WIDTH, Data::HEIGHT); },
+        [projection, view](FrameGraph&) {
+            Data::geometry_timer->begin();
+
+            geometry_pass(projection, view);
+
+            Data::geometry_timer->end();
+        });
+
+    graph.add_pass("Lighting",
+        [&](FrameGraph::Builder& builder) {
+            builder.read(directional_shadows);
+            builder.read(omnidirectional_shadows);
+            builder.read(spot_shadows);
+
+            if (Data::shadow_mask_enabled)
+            {
+                builder.read(shadow_mask);
+            }
+
+            if (Data::deferred_shading)
+            {
+                gbuffer.declare_reads(builder);
+            }
+            else if (prepass)
+            {
+                builder.read(camera_depth);
+            }
+
+            builder.write(window);
+            builder.side_effects();
+        },
+        [projection, view, gbuffer, camera_depth](FrameGraph& graph) {
+            Data::lighting_timer->begin();
+
+            if (Data::deferred_shading)
+            {
+                deferred_lighting_pass(projection, view, graph, gbuffer);
+            }
+            else
+            {
+                render_pass(projection, view, graph, camera_depth);
+            }
+
+            Data::lighting_timer->end();
+        });
+
+    // For the next frame's culling. Kept as long as this frame's culling reads
+    // the pyramid, on the assumption that the next frame runs the same passes.
+    if (gpu_culling)
+    {
+        graph.add_pass("Depth pyramid",
+            [&](FrameGraph::Builder& builder) {
+                builder.read(Data::deferred_shading ? gbuffer.depth : window);
+                builder.write(depth_pyramid);
+            },
+            [view_projection, gbuffer](FrameGraph& graph) {
+                build_depth_pyramid(view_projection, Data::deferred_shading ? graph.get_texture(gbuffer.depth) : 0);
+            });
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Bakes the potentially visible sets of the scene into Data::pvs_path and exits
+    bool bake_pvs = argc > 1 && std::string_view{argv[1]} == "--bake-pvs";
+
+    auto main_window = Window::create(Data::WIDTH, Data::HEIGHT, "Skybox");
+
+    if (main_window == nullptr)
+    {
+        return EXIT_FAILURE;
+    }
+
+    Data::shadow_atlas = std::make_shared<ShadowAtlas>(ShadowAtlas::get_settings(Data::SHADOW_QUALITY));
+
+    if (!Data::shadow_atlas->init())
+    {
+        return EXIT_FAILURE;
+    }
+
+    Data::shadow_scheduler = std::make_shared<ShadowScheduler>(Data::SHADOW_FACE_BUDGET);
+
+    Data::shadow_filter = std::make_shared<ShadowFilter>(
+        Shader::create_from_files(Data::shadow_filter_vertex_shader_path, Data::evsm_filter_fragment_shader_path),
+        Shader::create_from_files(Data::shadow_filter_vertex_shader_path, Data::esm_filter_fragment_shader_path)
+    );
+
+    if (!Data::shadow_filter->init())
+    {
+        return EXIT_FAILURE;
+    }
+
+    specify_vertices();
+    create_shaders_program();
+    create_textures_and_materials();
+
+    Data::shadow_mask = std::make_shared<ShadowMask>(Data::shader_list[6]);
+
+    if (!Data::shadow_mask->init(Data::WIDTH, Data::HEIGHT, ShadowMask::Resolution::HALF))
+    {
+        return EXIT_FAILURE;
+    }
+
+    auto xwing = std::make_shared<Model>(Data::root_path);
+    xwing->load("x-wing.obj");
+    Data::model_list.push_back(xwing);
+
+    auto black_hawk = std::make_shared<Model>(Data::root_path);
+    black_hawk->load("uh60.obj");
+    Data::model_list.push_back(black_hawk);
+
+    Data::camera = std::make_shared<Camera>(glm::vec3{-3.f, 2.f, 3.f}, glm::vec3{0.f, 1.f, 0.f}, 0.f, -60.f, 5.f, 20.0f);
+
+    Data::main_light = std::make_shared<DirectionalLight>(
+        512, 512,           // shadow map size per cascade
+        4,                  // number of cascades
+        1.f, 0.5f, 0.3f,    // color
+        0.1f, 0.6f,         // ambient and diffuse intensity
+        -8.f, -10.f, 14.f   //direction
+    );
+
+    /*Data::point_lights.push_back(
+        std::make_shared<PointLight>(
+            1024, 1024,        // shadow map size
+            0.1f, 100.f,       // near and far
+            0.f, 0.f, 1.f,     // color
+            0.f, 0.4f,         // ambient and diffuse intensity
+            4.f, 0.f, 0.f,     // position
+            0.01f, 0.01f, 0.3f // a, b, c
+        )
+    );
+    Data::point_lights.push_back(
+        std::make_shared<PointLight>(
+            1024, 1024,        // shadow map size
+            0.1f, 100.f,       // near and far
+            0.f, 1.f, 0.f,     // color
+            0.f, 0.4f,         // ambient and diffuse intensity
+            -4.f, 2.f, 0.f,    // position
+            0.01f, 0.01f, 0.3f // a, b, c
+        )
+    );*/
+
+    /*Data::spot_lights.push_back(
+        std::make_shared<SpotLight>(
+            Data::shadow_atlas,
+            0.1f, 100.f,     // near and far
+            1.f, 1.f, 1.f,   // color
+            0.f, 2.f,        // ambient and diffuse intensity
+            0.f, 3.f, -5.f,  // position
+            0.f, 0.f, 1.f,   // a, b, c
+            0.f, -1.f, 0.f,  // direction
+            20.f             // edge
+        )
+    );*/
+
+    Data::sky_box = std::make_shared<SkyBox>(
+        Data::root_path,
+        std::vector<fs::path>{{
+            "cupertin-lake_rt.tga",
+            "cupertin-lake_lf.tga",
+            "cupertin-lake_up.tga",
+            "cupertin-lake_dn.tga",
+            "cupertin-lake_bk.tga",
+            "cupertin-lake_ft.tga",
+        }}
+    );
+
+    Data::lighting_timer = std::make_shared<PassTimer>("Lighting (" + pcf_mode_name(Data::pcf_mode) + ")");
+    Data::geometry_timer = std::make_shared<PassTimer>("Geometry (deferred)");
+    Data::overdraw_counter = std::make_shared<OverdrawCounter>("Forward pass");
+    Data::omnidirectional_shadow_timer = std::make_shared<PassTimer>("Omnidirectional shadows (" + omnidirectional_shadow_mode_name(Data::omnidirectional_shadow_mode) + ")");
+
+    glm::mat4 projection = glm::perspective(glm::radians(Data::FIELD_OF_VIEW), main_window->get_aspect_ratio(), Data::NEAR_PLANE, Data::FAR_PLANE);
+
+    Data::draw_list = std::make_shared<DrawList>();
+
+    if (!Data::draw_list->init())
+    {
+        return EXIT_FAILURE;
+    }
+
+    Data::frame_graph = std::make_shared<FrameGraph>();
+
+    Data::pvs = std::make_shared<PotentiallyVisibleSet>();
+
+    // The static items already stand where every frame will put them
+    build_draw_list();
+
+    if (bake_pvs)
+    {
+        return Data::pvs->bake(*Data::draw_list, Data::NEAR_PLANE, Data::FAR_PLANE) && Data::pvs->save(Data::pvs_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    Data::pvs->load(Data::pvs_path, *Data::draw_list);
+
+    if (GpuCulling::is_supported())
+    {
+        Data::depth_pyramid = std::make_shared<DepthPyramid>(Shader::create_compute_from_file(Data::depth_pyramid_compute_shader_path));
+
+        if (!Data::depth_pyramid->init(Data::WIDTH, Data::HEIGHT))
+        {
+            return EXIT_FAILURE;
+        }
+
+        Data::gpu_culling = std::make_shared<GpuCulling>(Shader::create_compute_from_file(Data::cull_compute_shader_path));
+
+        if (!Data::gpu_culling->init())
+        {
+            return EXIT_FAILURE;
+        }
+
+        Data::camera_culling = CameraCulling::GPU;
+    }
+
+    Data::occlusion_culling = std::make_shared<OcclusionCulling>(Shader::create_depth_only_from_files(Data::occlusion_box_vertex_shader_path), 2.f * Data::NEAR_PLANE);
+
+    if (!Data::occlusion_culling->init())
+    {
+        return EXIT_FAILURE;
+    }
+
+    Data::camera_occlusion = std::make_shared<SoftwareOcclusion>("Camera occlusion", 256, 192);
+    Data::shadow_occlusion = std::make_shared<SoftwareOcclusion>("Spot shadow occlusion", 256, 256);
+
+    Data::light_table = std::make_shared<LightTable>();
+    Data::light_clusters = std::make_shared<LightClusters>();
+
+    if (!Data::light_clusters->init())
+    {
+        return EXIT_FAILURE;
+    }
+
+    Data::light_clusters->set_projection(glm::radians(Data::FIELD_OF_VIEW), main_window->get_aspect_ratio(), Data::NEAR_PLANE, Data::FAR_PLANE);
+
+    GLfloat last_time = glfwGetTime();
+    
+    while (!main_window->should_be_closed())
+    {
+        GLfloat now = glfwGetTime();
+        GLfloat dt = now - last_time;
+        last_time = now;
+
+        // Get and handle user input events
+        glfwPollEvents();
+
+        Data::camera->handle_keys(main_window->get_keys());
+        Data::camera->handle_mouse(main_window->get_x_change(), main_window->get_y_change());
+        Data::camera->update(dt);
+
+        handle_render_options(main_window->get_keys());
+
+        Data::main_light->update_cascades(Data::camera->get_view_matrix(), glm::radians(Data::FIELD_OF_VIEW), main_window->get_aspect_ratio(), Data::NEAR_PLANE, Data::FAR_PLANE);
+
+        update_scene(dt);
+        build_draw_list();
+        Data::draw_list->upload();
+
+        Data::pvs->set_position(Data::camera->get_position());
+
+        glm::mat4 view_projection = projection * Data::camera->get_view_matrix();
+        Data::view_frustum = Frustum{view_projection};
+
+        if (Data::camera_culling == CameraCulling::SOFTWARE_OCCLUSION)
+        {
+            Data::camera_occlusion->render(*Data::draw_list, view_projection);
+        }
+        else if (Data::camera_culling == CameraCulling::OCCLUSION_QUERIES)
+        {
+            Data::occlusion_culling->begin_frame(*Data::draw_list);
+        }
+
+        // Before anything reads the lights' derived data this frame
+        Data::light_table->update(Data::point_lights, Data::spot_lights, Shader::MAX_POINT_LIGHTS, Shader::MAX_SPOT_LIGHTS);
+        Data::light_clusters->update(Data::camera->get_view_matrix(), *Data::light_table);
+
+        // Decided before the graph is built, which places the prepass
+        if (!Data::deferred_shading)
+        {
+            update_depth_prepass();
+        }
+
+        build_frame_graph(projection, Data::camera->get_view_matrix(), view_projection, main_window->get_buffer_height());
+
+        Data::depth_pyramid_built = false;
+
+        Data::frame_graph->compile();
+        Data::frame_graph->execute();
+
+        // Without a depth pass to cull for, the pyramid was not rebuilt and is too old to test against
+        if (Data::camera_culling == CameraCulling::GPU && !Data::depth_pyramid_built)
+        {
+            Data::depth_pyramid->invalidate();
+        }
+
+        if (Data::camera_culling == CameraCulling::SOFTWARE_OCCLUSION)
+        {
+            Data::camera_occlusion->end_frame();
+            Data::shadow_occlusion->end_frame();
+        }
+        else if (Data::camera_culling == CameraCulling::OCCLUSION_QUERIES)
+        {
+            Data::occlusion_culling->end_frame();
+        }
 
         glUseProgram(0);
 
+        Data::draw_list->end_frame();
+
         main_window->swap_buffers();
     }
     
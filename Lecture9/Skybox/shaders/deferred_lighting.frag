@@ -0,0 +1,56 @@
+#version 410
+
+in vec2 texture_coordinates;
+
+out vec4 color;
+
+uniform sampler2D gbuffer_albedo_specular;
+uniform sampler2D gbuffer_normal_shininess;
+uniform sampler2D gbuffer_depth;
+uniform mat4 inverse_view_projection;
+uniform mat4 view;
+uniform vec3 eye_position;
+uniform bool show_shadow_samples; // Heatmap of the omnidirectional PCF samples taken
+
+// Decoded from the G-buffer instead of coming from a vertex shader
+vec3 fragment_position;
+vec3 normal;
+float view_depth;
+
+#include "lights.glsl"
+
+Material material;
+
+#include "shadows.glsl"
+
+#include "lighting.glsl"
+
+#include "gbuffer.glsl"
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gbuffer_depth, texel, 0).r;
+
+    // The sky box is already there
+    if (depth == 1.0)
+    {
+        discard;
+    }
+
+    vec4 albedo_specular = texelFetch(gbuffer_albedo_specular, texel, 0);
+    vec4 normal_shininess = texelFetch(gbuffer_normal_shininess, texel, 0);
+
+    vec4 world_position = inverse_view_projection * vec4(vec3(texture_coordinates, depth) * 2.0 - 1.0, 1.0);
+    fragment_position = world_position.xyz / world_position.w;
+    view_depth = -(view * vec4(fragment_position, 1.0)).z;
+    normal = decode_normal(normal_shininess.xy);
+    material = Material(decode_specular_intensity(albedo_specular.a), decode_shininess(normal_shininess.z));
+
+    color = vec4(albedo_specular.rgb, 1.0) * calculate_lighting();
+
+    if (show_shadow_samples)
+    {
+        color = shadow_samples_heatmap();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 410
+
+layout (location = 0) in vec3 pos;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// Must match shader.vert operation for operation, the main pass tests for equal depth
+invariant gl_Position;
+
+#include "draw_data.glsl"
+
+void main()
+{
+    vec4 view_position = view * draw_model_matrix() * vec4(pos.x, pos.y, pos.z, 1.0);
+    gl_Position = projection * view_position;
+}
\ No newline at end of file
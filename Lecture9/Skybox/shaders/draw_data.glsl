@@ -0,0 +1,33 @@
+// Per-draw data DrawList writes once a frame, TEXELS_PER_DRAW texels per
+// draw: the model matrix columns, the normal matrix columns, the
+// material (specular intensity, shininess) and the mask of cube faces a
+// layered shadow draw covers. The draw ID is a constant
+// vertex attribute set before each draw call.
+
+const int TEXELS_PER_DRAW = 8;
+
+layout (location = 3) in int draw_id;
+
+uniform samplerBuffer draw_data;
+
+mat4 draw_model_matrix()
+{
+    int base = draw_id * TEXELS_PER_DRAW;
+    return mat4(texelFetch(draw_data, base), texelFetch(draw_data, base + 1), texelFetch(draw_data, base + 2), texelFetch(draw_data, base + 3));
+}
+
+mat3 draw_normal_matrix()
+{
+    int base = draw_id * TEXELS_PER_DRAW + 4;
+    return mat3(texelFetch(draw_data, base).xyz, texelFetch(draw_data, base + 1).xyz, texelFetch(draw_data, base + 2).xyz);
+}
+
+vec2 draw_material()
+{
+    return texelFetch(draw_data, draw_id * TEXELS_PER_DRAW + 7).xy;
+}
+
+int draw_face_mask()
+{
+    return int(texelFetch(draw_data, draw_id * TEXELS_PER_DRAW + 7).z);
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#version 410
+
+const int KERNEL_RADIUS = 4;
+const float ESM_EXPONENT = 80.0;
+
+in vec2 texture_coordinates;
+
+out float moment;
+
+uniform samplerCubeArray source;
+uniform int source_layer;   // Cube of the light in the source array
+uniform int face;
+uniform vec2 texel_step;    // One texel along the blur direction
+uniform bool convert_depth; // The source holds depth instead of the exponential
+uniform bool hardware_depth; // The source depth is perspective, linearized before the exponential
+uniform float near_plane;
+uniform float far_plane;
+
+float weights[KERNEL_RADIUS + 1] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+
+// Direction of a face texel, past the face edges it continues on the neighbour face
+vec3 face_direction(vec2 coordinates)
+{
+    vec2 st = coordinates * 2.0 - 1.0;
+
+    switch (face)
+    {
+        case 0: return vec3(1.0, -st.y, -st.x);
+        case 1: return vec3(-1.0, -st.y, st.x);
+        case 2: return vec3(st.x, 1.0, st.y);
+        case 3: return vec3(st.x, -1.0, -st.y);
+        case 4: return vec3(st.x, -st.y, 1.0);
+        default: return vec3(-st.x, -st.y, -1.0);
+    }
+}
+
+float fetch(vec2 coordinates)
+{
+    float value = texture(source, vec4(face_direction(coordinates), source_layer)).r;
+
+    if (convert_depth && hardware_depth)
+    {
+        float z = value * 2.0 - 1.0;
+        value = 2.0 * near_plane * far_plane / (far_plane + near_plane - z * (far_plane - near_plane)) / far_plane;
+    }
+
+    return convert_depth ? exp(ESM_EXPONENT * value) : value;
+}
+
+void main()
+{
+    moment = fetch(texture_coordinates) * weights[0];
+
+    for (int i = 1; i <= KERNEL_RADIUS; ++i)
+    {
+        moment += fetch(texture_coordinates + i * texel_step) * weights[i];
+        moment += fetch(texture_coordinates - i * texel_step) * weights[i];
+    }
+}
\ No newline at end of file
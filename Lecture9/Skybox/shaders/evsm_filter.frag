@@ -0,0 +1,44 @@
+#version 410
+
+const int KERNEL_RADIUS = 4;
+const float EVSM_POSITIVE_EXPONENT = 40.0;
+const float EVSM_NEGATIVE_EXPONENT = 5.0;
+
+in vec2 texture_coordinates;
+
+out vec4 moments;
+
+uniform sampler2DArray source;
+uniform int source_layer;
+uniform vec2 texel_step;    // One texel along the blur direction
+uniform bool convert_depth; // The source holds depth instead of moments
+
+float weights[KERNEL_RADIUS + 1] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+
+vec4 fetch(vec2 coordinates)
+{
+    vec4 value = texture(source, vec3(coordinates, source_layer));
+
+    if (!convert_depth)
+    {
+        return value;
+    }
+
+    // Warp the depth into [-1, 1] before raising it
+    float depth = value.r * 2.0 - 1.0;
+    float positive = exp(EVSM_POSITIVE_EXPONENT * depth);
+    float negative = -exp(-EVSM_NEGATIVE_EXPONENT * depth);
+
+    return vec4(positive, positive * positive, negative, negative * negative);
+}
+
+void main()
+{
+    moments = fetch(texture_coordinates) * weights[0];
+
+    for (int i = 1; i <= KERNEL_RADIUS; ++i)
+    {
+        moments += fetch(texture_coordinates + i * texel_step) * weights[i];
+        moments += fetch(texture_coordinates - i * texel_step) * weights[i];
+    }
+}
\ No newline at end of file
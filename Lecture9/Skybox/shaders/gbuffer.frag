@@ -0,0 +1,28 @@
+#version 410
+
+in vec2 texture_coordinates;
+in vec3 normal;
+in vec3 fragment_position;
+in float view_depth;
+flat in vec2 material_parameters;
+
+layout (location = 0) out vec4 albedo_specular;
+layout (location = 1) out vec4 normal_shininess;
+
+struct Material
+{
+    float specular_intensity;
+    float shininess;
+};
+
+uniform sampler2D the_texture;
+
+#include "gbuffer.glsl"
+
+void main()
+{
+    Material material = Material(material_parameters.x, material_parameters.y);
+
+    albedo_specular = vec4(texture(the_texture, texture_coordinates).rgb, encode_specular_intensity(material.specular_intensity));
+    normal_shininess = vec4(encode_normal(normalize(normal)), encode_shininess(material.shininess), 0.0);
+}
\ No newline at end of file
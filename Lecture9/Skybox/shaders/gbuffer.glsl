@@ -0,0 +1,50 @@
+// G-buffer packing shared by the geometry and the deferred lighting programs.
+// Target 0 (RGBA8): albedo and specular intensity.
+// Target 1 (RGB10_A2): octahedral normal and log2 of the shininess.
+
+const float MAX_SPECULAR_INTENSITY = 4.0;
+const float MAX_SHININESS_EXPONENT = 10.0; // log2 of the largest shininess, 1024
+
+vec2 sign_not_zero(vec2 v)
+{
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// Unit vector folded onto the octahedron and into [0, 1]^2
+vec2 encode_normal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 folded = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * sign_not_zero(n.xy);
+
+    return folded * 0.5 + 0.5;
+}
+
+vec3 decode_normal(vec2 encoded)
+{
+    encoded = encoded * 2.0 - 1.0;
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy -= t * sign_not_zero(n.xy);
+
+    return normalize(n);
+}
+
+float encode_specular_intensity(float intensity)
+{
+    return clamp(intensity / MAX_SPECULAR_INTENSITY, 0.0, 1.0);
+}
+
+float decode_specular_intensity(float encoded)
+{
+    return encoded * MAX_SPECULAR_INTENSITY;
+}
+
+float encode_shininess(float shininess)
+{
+    return clamp(log2(max(shininess, 1.0)) / MAX_SHININESS_EXPONENT, 0.0, 1.0);
+}
+
+float decode_shininess(float encoded)
+{
+    return exp2(encoded * MAX_SHININESS_EXPONENT);
+}
\ No newline at end of file
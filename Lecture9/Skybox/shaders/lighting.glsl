@@ -0,0 +1,197 @@
+// Shading shared by the forward and the deferred lighting programs.
+// Needs lights.glsl and shadows.glsl, and material, fragment_position,
+// normal, view_depth and eye_position declared before it.
+
+// Must match ShadowMask::NUM_LAYERS
+const int NUM_MASK_LAYERS = 3;
+const float BILATERAL_DEPTH_TOLERANCE = 0.01; // Relative view depth difference
+
+uniform bool shadow_mask_enabled; // Directional and point light shadows come from the mask
+uniform sampler2DArray shadow_mask;
+uniform sampler2D shadow_mask_depth;
+uniform vec2 shadow_mask_scale; // Mask texels per window pixel
+
+vec4 shadow_mask_layers[NUM_MASK_LAYERS];
+
+// Must match LightClusters
+const int CLUSTERS_X = 16;
+const int CLUSTERS_Y = 9;
+const int CLUSTERS_Z = 24;
+const int TEXELS_PER_LIGHT = 4; // color and ambient, position and diffuse, attenuation and shadow, direction and edge
+
+uniform samplerBuffer cluster_lights;
+uniform usamplerBuffer cluster_table;         // Offset and count of every cluster
+uniform usamplerBuffer cluster_light_indices;
+uniform int num_cluster_point_lights;         // The spot lights come after them
+uniform vec2 cluster_tile_scale;              // Tiles per window pixel
+uniform vec2 cluster_depth_slicing;           // Slice = x * log(view depth) + y
+
+// Bilinear weights of the four nearest mask texels, scaled down where their
+// depth differs from this fragment's so shadows do not bleed across edges
+void upsample_shadow_mask()
+{
+    vec2 position = gl_FragCoord.xy * shadow_mask_scale - 0.5;
+    vec2 f = fract(position);
+    ivec2 base = ivec2(floor(position));
+    ivec2 last = textureSize(shadow_mask_depth, 0) - 1;
+    int num_layers = min(num_point_lights / 4 + 1, NUM_MASK_LAYERS);
+    float total = 0.0;
+
+    for (int layer = 0; layer < NUM_MASK_LAYERS; ++layer)
+    {
+        shadow_mask_layers[layer] = vec4(0.0);
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 texel = clamp(base + offset, ivec2(0), last);
+        vec2 bilinear = mix(1.0 - f, f, vec2(offset));
+
+        float depth_difference = abs(texelFetch(shadow_mask_depth, texel, 0).r - view_depth) / view_depth;
+        float weight = bilinear.x * bilinear.y / (BILATERAL_DEPTH_TOLERANCE + depth_difference);
+
+        for (int layer = 0; layer < num_layers; ++layer)
+        {
+            shadow_mask_layers[layer] += weight * texelFetch(shadow_mask, ivec3(texel, layer), 0);
+        }
+
+        total += weight;
+    }
+
+    for (int layer = 0; layer < num_layers; ++layer)
+    {
+        shadow_mask_layers[layer] /= total;
+    }
+}
+
+// Channel 0 is the directional light, channel i + 1 the point light i
+float shadow_mask_value(int channel)
+{
+    return shadow_mask_layers[channel / 4][channel % 4];
+}
+
+vec4 calculate_light_by_direction(Light light, vec3 direction, float shadow_factor)
+{
+    vec4 ambient_color = vec4(light.color, 1.0) * light.ambient_intensity;
+
+    // Every caller passes a normalized direction, the directional one is normalized on the CPU
+    float diffuse_factor = max(dot(normalize(normal), direction), 0.0);
+    vec4 diffuse_color = vec4(light.color, 1.0) * light.diffuse_intensity * diffuse_factor;
+
+    vec4 specular_color = vec4(0, 0, 0, 0);
+
+    if (diffuse_factor > 0.0)
+    {
+        vec3 fragment_to_eye = normalize(eye_position - fragment_position);
+        vec3 reflected_vertex = normalize(reflect(direction, normalize(normal)));
+        float specular_factor = dot(fragment_to_eye, reflected_vertex);
+
+        if (specular_factor > 0.0)
+        {
+            specular_factor = pow(specular_factor, material.shininess);
+            specular_color = vec4(light.color * material.specular_intensity * specular_factor, 1.0);
+        }
+    }
+
+    return ambient_color + (1.0 - shadow_factor) * (diffuse_color + specular_color);
+}
+
+vec4 calculate_directional_light()
+{
+    float shadow_factor = shadow_mask_enabled ? shadow_mask_value(0) : calculate_directional_shadow_factor(directional_light);
+    return calculate_light_by_direction(directional_light.base, directional_light.direction, shadow_factor);
+}
+
+vec4 calculate_point_light(PointLight light, float shadow_factor)
+{
+    vec3 direction = fragment_position - light.position;
+    float distance = length(direction);
+    direction = normalize(direction);
+
+    vec4 color = calculate_light_by_direction(light.base, direction, shadow_factor);
+
+    float attenuation = light.a * distance * distance +
+                        light.b * distance +
+                        light.c;
+                        
+    return (color / attenuation);
+}
+
+vec4 calculate_spot_light(SpotLight light, int shadow_index)
+{
+    vec3 ray_direction = normalize(fragment_position - light.base.position);
+    float factor = dot(ray_direction, light.direction);
+
+    if (factor > light.edge)
+    {
+        float shadow_factor = shadow_index < 0 ? 0.0 : calculate_spot_shadow_factor(shadow_index);
+        return calculate_point_light(light.base, shadow_factor) * (1.0 - (1.0 - factor) * (1.0 / (1.0 - light.edge)));
+    }
+
+    return vec4(0.0, 0.0, 0.0, 0.0);
+}
+
+// Only the lights binned into this fragment's cluster
+vec4 calculate_clustered_lights()
+{
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy * cluster_tile_scale), ivec2(0), ivec2(CLUSTERS_X - 1, CLUSTERS_Y - 1));
+    int slice = clamp(int(log(view_depth) * cluster_depth_slicing.x + cluster_depth_slicing.y), 0, CLUSTERS_Z - 1);
+    uvec2 range = texelFetch(cluster_table, (slice * CLUSTERS_Y + tile.y) * CLUSTERS_X + tile.x).rg;
+
+    vec4 total_color = vec4(0, 0, 0, 0);
+
+    for (uint i = 0u; i < range.y; ++i)
+    {
+        int light_index = int(texelFetch(cluster_light_indices, int(range.x + i)).r);
+        int base = light_index * TEXELS_PER_LIGHT;
+
+        vec4 color_ambient = texelFetch(cluster_lights, base);
+        vec4 position_diffuse = texelFetch(cluster_lights, base + 1);
+        vec4 attenuation_shadow = texelFetch(cluster_lights, base + 2);
+        vec4 direction_edge = texelFetch(cluster_lights, base + 3);
+
+        PointLight light = PointLight(Light(color_ambient.rgb, color_ambient.a, position_diffuse.a), position_diffuse.xyz,
+                                      attenuation_shadow.x, attenuation_shadow.y, attenuation_shadow.z);
+        int shadow_index = int(attenuation_shadow.w);
+
+        if (light_index < num_cluster_point_lights)
+        {
+            float shadow_factor = 0.0;
+
+            if (shadow_index >= 0)
+            {
+                shadow_factor = shadow_mask_enabled ? shadow_mask_value(shadow_index + 1) : calculate_omnidirectional_shadow_factor(light, shadow_index);
+            }
+
+            total_color += calculate_point_light(light, shadow_factor);
+        }
+        else
+        {
+            total_color += calculate_spot_light(SpotLight(light, direction_edge.xyz, direction_edge.w), shadow_index);
+        }
+    }
+
+    return total_color;
+}
+
+// Total light of the directional light and the lights of this fragment's cluster
+vec4 calculate_lighting()
+{
+    if (shadow_mask_enabled)
+    {
+        upsample_shadow_mask();
+    }
+
+    return calculate_directional_light() + calculate_clustered_lights();
+}
+
+// Black: no lookup, green: early out everywhere, red: full kernel everywhere
+vec4 shadow_samples_heatmap()
+{
+    float full = float(OMNIDIRECTIONAL_SAMPLES * max(omnidirectional_lookups, 1));
+    float early = float(OMNIDIRECTIONAL_EARLY_SAMPLES * max(omnidirectional_lookups, 1));
+    float heat = clamp((float(omnidirectional_samples_taken) - early) / (full - early), 0.0, 1.0);
+
+    return omnidirectional_lookups == 0 ? vec4(0.0, 0.0, 0.0, 1.0) : vec4(heat, 1.0 - heat, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+// Light types and uniforms shared by the lighting and shadow mask programs.
+// The lighting shader reads its lights from the cluster buffers, the arrays
+// here only describe the first, shadowed lights of each kind.
+
+const int MAX_POINT_LIGHTS = 10;
+const int MAX_SPOT_LIGHTS = 10;
+
+struct Light
+{
+    vec3 color;
+    float ambient_intensity;
+    float diffuse_intensity;
+};
+
+struct DirectionalLight
+{
+    Light base;
+    vec3 direction;
+};
+
+struct PointLight
+{
+    Light base;
+    vec3 position;
+    float a;
+    float b;
+    float c;
+};
+
+struct SpotLight
+{
+    PointLight base;
+    vec3 direction;
+    float edge;
+};
+
+struct Material
+{
+    float specular_intensity;
+    float shininess;
+};
+
+uniform DirectionalLight directional_light;
+uniform PointLight point_lights[MAX_POINT_LIGHTS];
+uniform int num_point_lights;
+uniform SpotLight spot_lights[MAX_SPOT_LIGHTS];
+uniform int num_spot_lights;
\ No newline at end of file
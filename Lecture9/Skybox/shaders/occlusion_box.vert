@@ -0,0 +1,26 @@
+#version 410
+
+// The twelve triangles of an axis-aligned box from the vertex index, drawn
+// with color and depth writes off behind an occlusion query
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 bounds_min;
+uniform vec3 bounds_max;
+
+// Corners numbered by their x, y and z bits
+const int CORNERS[36] = int[](
+    0, 2, 1, 1, 2, 3, // -z
+    4, 5, 6, 5, 7, 6, // +z
+    0, 1, 4, 1, 5, 4, // -y
+    2, 6, 3, 3, 6, 7, // +y
+    0, 4, 2, 2, 4, 6, // -x
+    1, 3, 5, 3, 7, 5  // +x
+);
+
+void main()
+{
+    int corner = CORNERS[gl_VertexID];
+    vec3 position = mix(bounds_min, bounds_max, vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1));
+    gl_Position = projection * view * vec4(position, 1.0);
+}
\ No newline at end of file
@@ -2,9 +2,9 @@
 
 layout (location = 0) in vec3 pos;
 
-uniform mat4 model;
+#include "draw_data.glsl"
 
 void main()
 {
-    gl_Position = model * vec4(pos, 1.0);
+    gl_Position = draw_model_matrix() * vec4(pos, 1.0);
 }
\ No newline at end of file
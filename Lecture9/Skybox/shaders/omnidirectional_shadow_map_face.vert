@@ -0,0 +1,18 @@
+#version 410
+
+const int NUM_FACES = 6;
+
+layout (location = 0) in vec3 pos;
+
+#include "draw_data.glsl"
+
+uniform mat4 light_matrices[NUM_FACES];
+uniform int face;
+
+out vec4 fragment_position;
+
+void main()
+{
+    fragment_position = draw_model_matrix() * vec4(pos, 1.0);
+    gl_Position = light_matrices[face] * fragment_position;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#version 410
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+
+const int NUM_FACES = 6;
+
+layout (location = 0) in vec3 pos;
+
+#include "draw_data.glsl"
+
+uniform mat4 light_matrices[NUM_FACES];
+uniform int layer_offset;
+
+out vec4 fragment_position;
+
+void main()
+{
+    // One instance per cube face the object overlaps: the instance ID-th set bit of its mask
+    int mask = draw_face_mask();
+    int face = 0;
+
+    for (int skipped = 0; face < NUM_FACES; ++face)
+    {
+        if ((mask & (1 << face)) != 0)
+        {
+            if (skipped == gl_InstanceID)
+            {
+                break;
+            }
+
+            ++skipped;
+        }
+    }
+
+    fragment_position = draw_model_matrix() * vec4(pos, 1.0);
+    gl_Position = light_matrices[face] * fragment_position;
+    gl_Layer = layer_offset + face;
+}
\ No newline at end of file
@@ -7,21 +7,27 @@ layout(location = 2) in vec3 norm;
 out vec2 texture_coordinates;
 out vec3 normal;
 out vec3 fragment_position;
-out vec4 directional_light_space_pos;
+out float view_depth;
+flat out vec2 material_parameters;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
-uniform mat4 directional_light_space_transform;
+
+invariant gl_Position;
+
+#include "draw_data.glsl"
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(pos.x, pos.y, pos.z, 1.0);
-    directional_light_space_pos = directional_light_space_transform * model * vec4(pos, 1.0);
+    mat4 model = draw_model_matrix();
+    vec4 view_position = view * model * vec4(pos.x, pos.y, pos.z, 1.0);
+    gl_Position = projection * view_position;
+    view_depth = -view_position.z;
     
     texture_coordinates = tex;
     
-    normal = mat3(transpose(inverse(model))) * norm;
+    normal = draw_normal_matrix() * norm;
+    material_parameters = draw_material();
 
     fragment_position = (model * vec4(pos.x, pos.y, pos.z, 1.0)).xyz;
 }
\ No newline at end of file
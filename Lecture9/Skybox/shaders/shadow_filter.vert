@@ -0,0 +1,11 @@
+#version 410
+
+out vec2 texture_coordinates;
+
+void main()
+{
+    // Fullscreen triangle from the vertex index, no vertex buffer needed
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    texture_coordinates = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#version 410
+
+// Must match ShadowMask::NUM_LAYERS: the directional light, then one channel per point light
+const int NUM_MASK_LAYERS = 3;
+
+in vec2 texture_coordinates;
+
+layout (location = 0) out vec4 mask_0;
+layout (location = 1) out vec4 mask_1;
+layout (location = 2) out vec4 mask_2;
+layout (location = 3) out float mask_depth; // View depth of the texel, for the bilateral upsampling
+
+uniform sampler2D scene_depth;
+uniform mat4 inverse_view_projection;
+uniform mat4 view;
+uniform vec3 eye_position;
+
+// Rebuilt from the depth prepass instead of coming from a vertex shader
+vec3 fragment_position;
+vec3 normal;
+float view_depth;
+
+#include "lights.glsl"
+
+#include "shadows.glsl"
+
+void main()
+{
+    float depth = texture(scene_depth, texture_coordinates).r;
+
+    vec4 world_position = inverse_view_projection * vec4(vec3(texture_coordinates, depth) * 2.0 - 1.0, 1.0);
+    fragment_position = world_position.xyz / world_position.w;
+    view_depth = -(view * vec4(fragment_position, 1.0)).z;
+
+    // Derivatives before any branch. Facing the eye, the slope bias only needs the angle to the light.
+    normal = normalize(cross(dFdx(fragment_position), dFdy(fragment_position)));
+
+    if (dot(normal, eye_position - fragment_position) < 0.0)
+    {
+        normal = -normal;
+    }
+
+    // Nothing was drawn here
+    if (depth == 1.0)
+    {
+        mask_0 = mask_1 = mask_2 = vec4(0.0);
+        mask_depth = 1.0e30;
+        return;
+    }
+
+    float shadows[4 * NUM_MASK_LAYERS];
+    shadows[0] = calculate_directional_shadow_factor(directional_light);
+
+    for (int i = 1; i < 4 * NUM_MASK_LAYERS; ++i)
+    {
+        shadows[i] = i <= num_point_lights ? calculate_omnidirectional_shadow_factor(point_lights[i - 1], i - 1) : 0.0;
+    }
+
+    mask_0 = vec4(shadows[0], shadows[1], shadows[2], shadows[3]);
+    mask_1 = vec4(shadows[4], shadows[5], shadows[6], shadows[7]);
+    mask_2 = vec4(shadows[8], shadows[9], shadows[10], shadows[11]);
+    mask_depth = view_depth;
+}
\ No newline at end of file
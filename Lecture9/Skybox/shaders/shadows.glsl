@@ -0,0 +1,312 @@
+// Shadow lookups shared by the lighting and shadow mask programs.
+// Needs lights.glsl, and fragment_position, normal, view_depth and eye_position declared before it.
+
+const int MAX_CASCADES = 4;
+
+// Must match ShadowFilter::Mode::FILTERED and the exponents in evsm_filter.frag and esm_filter.frag
+const int FILTERED_SHADOWS = 1;
+const float EVSM_POSITIVE_EXPONENT = 40.0;
+const float EVSM_NEGATIVE_EXPONENT = 5.0;
+const float ESM_EXPONENT = 80.0;
+const float LIGHT_BLEEDING_REDUCTION = 0.3;
+
+// Must match ShadowMap::PCFMode
+const int PCF_NONE = 0;
+const int PCF_MANUAL_3X3 = 1;
+const int PCF_HARDWARE_2X2 = 2;
+const int PCF_HARDWARE_POISSON = 3;
+const int POISSON_SAMPLES = 9;
+const float POISSON_RADIUS = 1.5; // In texels
+const int OMNIDIRECTIONAL_SAMPLES = 20;
+const int OMNIDIRECTIONAL_EARLY_SAMPLES = 8; // The cube corners of grid_sampling_disk
+
+struct OmnidirectionalShadowMap
+{
+    int cube; // Layer of the light in omnidirectional_shadow_map_array, -1 if unshadowed
+    float near_plane;
+    float far_plane;
+};
+
+struct SpotShadowMap
+{
+    vec4 uv_scale_offset; // Tile in spot_shadow_atlas (xy: scale, zw: offset), zero scale if unshadowed
+    mat4 light_transform;
+};
+
+uniform sampler2DArray directional_shadow_map;
+uniform mat4 directional_light_space_transforms[MAX_CASCADES];
+uniform float cascade_splits[MAX_CASCADES];
+uniform int num_cascades;
+uniform samplerCubeArray omnidirectional_shadow_map_array;
+uniform OmnidirectionalShadowMap omnidirectional_shadow_maps[MAX_POINT_LIGHTS];
+uniform sampler2D spot_shadow_atlas;
+uniform SpotShadowMap spot_shadow_maps[MAX_SPOT_LIGHTS];
+uniform int shadow_filter_mode;
+uniform int pcf_mode;
+uniform bool omnidirectional_hardware_depth; // The cubes hold perspective depth instead of distance / far_plane
+uniform sampler2DArrayShadow directional_shadow_comparison;
+uniform sampler2DShadow spot_shadow_comparison;
+uniform sampler2DArray directional_moments;
+uniform samplerCubeArray omnidirectional_moment_array;
+
+vec3 grid_sampling_disk[20] = vec3[]
+(
+   vec3(1, 1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1, 1,  1), 
+   vec3(1, 1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1, 1, -1),
+   vec3(1, 1,  0), vec3( 1, -1,  0), vec3(-1, -1,  0), vec3(-1, 1,  0),
+   vec3(1, 0,  1), vec3(-1,  0,  1), vec3( 1,  0, -1), vec3(-1, 0, -1),
+   vec3(0, 1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0, 1, -1)
+);
+
+// Filled by calculate_omnidirectional_shadow_factor for the heatmap
+int omnidirectional_samples_taken = 0;
+int omnidirectional_lookups = 0;
+
+vec2 poisson_disk[POISSON_SAMPLES] = vec2[]
+(
+   vec2(0.0, 0.0), vec2(-0.94201624, -0.39906216), vec2(0.94558609, -0.76890725),
+   vec2(-0.09418410, -0.92938870), vec2(0.34495938, 0.29387760), vec2(-0.91588581, 0.45771432),
+   vec2(-0.81544232, -0.87912464), vec2(-0.38277543, 0.27676845), vec2(0.97484398, 0.75648379)
+);
+
+int select_cascade()
+{
+    for (int i = 0; i < num_cascades - 1; ++i)
+    {
+        if (view_depth < cascade_splits[i])
+        {
+            return i;
+        }
+    }
+
+    return num_cascades - 1;
+}
+
+// Upper bound on the lit fraction given the two first moments of the occluders' depth
+float chebyshev_upper_bound(vec2 moments, float depth, float min_variance)
+{
+    if (depth <= moments.x)
+    {
+        return 1.0;
+    }
+
+    float variance = max(moments.y - moments.x * moments.x, min_variance);
+    float d = depth - moments.x;
+    float p_max = variance / (variance + d * d);
+
+    // Cut the tail of p_max, which is where light bleeding shows
+    return clamp((p_max - LIGHT_BLEEDING_REDUCTION) / (1.0 - LIGHT_BLEEDING_REDUCTION), 0.0, 1.0);
+}
+
+float calculate_directional_evsm_factor(vec3 projection_coordinates, int cascade)
+{
+    vec4 moments = texture(directional_moments, vec3(projection_coordinates.xy, cascade));
+
+    float depth = projection_coordinates.z * 2.0 - 1.0;
+    float positive = exp(EVSM_POSITIVE_EXPONENT * depth);
+    float negative = -exp(-EVSM_NEGATIVE_EXPONENT * depth);
+
+    // The minimum variance follows the slope of each warp
+    float positive_scale = 0.0001 * EVSM_POSITIVE_EXPONENT * positive;
+    float negative_scale = 0.0001 * EVSM_NEGATIVE_EXPONENT * negative;
+
+    float lit = min(chebyshev_upper_bound(moments.xy, positive, positive_scale * positive_scale),
+                    chebyshev_upper_bound(moments.zw, negative, negative_scale * negative_scale));
+
+    return 1.0 - lit;
+}
+
+float calculate_directional_shadow_factor(DirectionalLight light)
+{
+    if (view_depth > cascade_splits[num_cascades - 1])
+    {
+        return 0.0;
+    }
+
+    int cascade = select_cascade();
+    vec4 directional_light_space_pos = directional_light_space_transforms[cascade] * vec4(fragment_position, 1.0);
+
+    vec3 projection_coordinates = directional_light_space_pos.xyz / directional_light_space_pos.w;
+    projection_coordinates = projection_coordinates * 0.5 + 0.5;
+
+    if (shadow_filter_mode == FILTERED_SHADOWS)
+    {
+        return projection_coordinates.z > 1.0 ? 0.0 : calculate_directional_evsm_factor(projection_coordinates, cascade);
+    }
+
+    float current = projection_coordinates.z;
+    
+    vec3 norm = normalize(normal);
+    vec3 light_dir = normalize(directional_light.direction);
+
+    float bias = max(0.05 * (1.0 - dot(normal, light_dir)), 0.0005);
+
+    float shadow = 0.0;
+
+    vec2 texel_size = 1.0 / textureSize(directional_shadow_map, 0).xy;
+
+    if (pcf_mode == PCF_NONE)
+    {
+        float closest = texture(directional_shadow_map, vec3(projection_coordinates.xy, cascade)).r;
+        shadow = current - bias > closest ? 1.0 : 0.0;
+    }
+    else if (pcf_mode == PCF_HARDWARE_2X2)
+    {
+        shadow = 1.0 - texture(directional_shadow_comparison, vec4(projection_coordinates.xy, cascade, current - bias));
+    }
+    else if (pcf_mode == PCF_HARDWARE_POISSON)
+    {
+        for (int i = 0; i < POISSON_SAMPLES; ++i)
+        {
+            vec2 coordinates = projection_coordinates.xy + poisson_disk[i] * POISSON_RADIUS * texel_size;
+            shadow += 1.0 - texture(directional_shadow_comparison, vec4(coordinates, cascade, current - bias));
+        }
+
+        shadow /= POISSON_SAMPLES;
+    }
+    else
+    {
+        for (int x = -1; x <= 1; ++x)
+        {
+            for (int y = -1; y <= 1; ++y)
+            {
+                float pcf_depth = texture(directional_shadow_map, vec3(projection_coordinates.xy + vec2(x, y) * texel_size, cascade)).r;
+                shadow += current - bias > pcf_depth ? 1.0 : 0.0;
+            }
+        }
+
+        shadow /= 9;
+    }
+
+    if (projection_coordinates.z > 1.0)
+    {
+        shadow = 0.0;
+    }
+
+    return shadow;
+}
+
+// Depth along the face axis from a perspective depth value of the cube
+float linearize_omnidirectional_depth(float depth, float near_plane, float far_plane)
+{
+    float z = depth * 2.0 - 1.0;
+
+    return 2.0 * near_plane * far_plane / (far_plane + near_plane - z * (far_plane - near_plane));
+}
+
+float calculate_omnidirectional_shadow_factor(PointLight light, int shadow_index)
+{
+    if (omnidirectional_shadow_maps[shadow_index].cube < 0)
+    {
+        return 0.0;
+    }
+
+    vec3 fragment_to_light = fragment_position - light.position;
+    float near_plane = omnidirectional_shadow_maps[shadow_index].near_plane;
+    float far_plane = omnidirectional_shadow_maps[shadow_index].far_plane;
+
+    // Hardware depth measures along the major axis, the face the direction selects
+    vec3 axis_distance = abs(fragment_to_light);
+    float current = omnidirectional_hardware_depth ? max(axis_distance.x, max(axis_distance.y, axis_distance.z)) : length(fragment_to_light);
+
+    float bias = 0.15;
+
+    if (shadow_filter_mode == FILTERED_SHADOWS)
+    {
+        float stored = texture(omnidirectional_moment_array, vec4(fragment_to_light, omnidirectional_shadow_maps[shadow_index].cube)).r;
+        float depth = (current - bias) / far_plane;
+
+        return 1.0 - clamp(stored * exp(-ESM_EXPONENT * depth), 0.0, 1.0);
+    }
+
+    float shadow = 0.0;
+    int samples = OMNIDIRECTIONAL_SAMPLES;
+    float view_distance = length(eye_position - fragment_position);
+    float disk_radius = (1.0 + (view_distance / far_plane)) / 25.0;
+
+    for(int i = 0; i < samples; ++i)
+	{
+		float closest = texture(omnidirectional_shadow_map_array, vec4(fragment_to_light + grid_sampling_disk[i] * disk_radius, omnidirectional_shadow_maps[shadow_index].cube)).r;
+		closest = omnidirectional_hardware_depth ? linearize_omnidirectional_depth(closest, near_plane, far_plane) : closest * far_plane;   // Undo mapping [0;1]
+		if(current - bias > closest)
+        {
+			shadow += 1.0;
+        }
+
+        // The corners span the whole kernel: when they agree the fragment is not in a penumbra
+        if (i == OMNIDIRECTIONAL_EARLY_SAMPLES - 1 && (shadow == 0.0 || shadow == float(OMNIDIRECTIONAL_EARLY_SAMPLES)))
+        {
+            samples = OMNIDIRECTIONAL_EARLY_SAMPLES;
+            break;
+        }
+	}
+
+    omnidirectional_samples_taken += samples;
+    ++omnidirectional_lookups;
+
+	shadow /= float(samples);  
+	
+	return shadow;
+}
+
+float calculate_spot_shadow_factor(int shadow_index)
+{
+    vec4 tile = spot_shadow_maps[shadow_index].uv_scale_offset;
+
+    if (tile.x == 0.0)
+    {
+        return 0.0;
+    }
+
+    vec4 light_space_pos = spot_shadow_maps[shadow_index].light_transform * vec4(fragment_position, 1.0);
+    vec3 projection_coordinates = light_space_pos.xyz / light_space_pos.w;
+    projection_coordinates = projection_coordinates * 0.5 + 0.5;
+
+    // Outside the light's tile there is no border to fall back on
+    if (projection_coordinates.z > 1.0 || any(lessThan(projection_coordinates.xy, vec2(0.0))) || any(greaterThan(projection_coordinates.xy, vec2(1.0))))
+    {
+        return 0.0;
+    }
+
+    float current = projection_coordinates.z;
+    float bias = 0.0005;
+    float shadow = 0.0;
+
+    vec2 texel_size = 1.0 / textureSize(spot_shadow_atlas, 0);
+    vec2 atlas_coordinates = tile.zw + projection_coordinates.xy * tile.xy;
+    vec2 tile_min = tile.zw + 0.5 * texel_size;
+    vec2 tile_max = tile.zw + tile.xy - 0.5 * texel_size;
+
+    if (pcf_mode == PCF_NONE)
+    {
+        float closest = texture(spot_shadow_atlas, clamp(atlas_coordinates, tile_min, tile_max)).r;
+        return current - bias > closest ? 1.0 : 0.0;
+    }
+
+    if (pcf_mode == PCF_HARDWARE_2X2)
+    {
+        return 1.0 - texture(spot_shadow_comparison, vec3(clamp(atlas_coordinates, tile_min, tile_max), current - bias));
+    }
+
+    if (pcf_mode == PCF_HARDWARE_POISSON)
+    {
+        for (int i = 0; i < POISSON_SAMPLES; ++i)
+        {
+            vec2 coordinates = clamp(atlas_coordinates + poisson_disk[i] * POISSON_RADIUS * texel_size, tile_min, tile_max);
+            shadow += 1.0 - texture(spot_shadow_comparison, vec3(coordinates, current - bias));
+        }
+
+        return shadow / POISSON_SAMPLES;
+    }
+
+    for (int x = -1; x <= 1; ++x)
+    {
+        for (int y = -1; y <= 1; ++y)
+        {
+            float pcf_depth = texture(spot_shadow_atlas, clamp(atlas_coordinates + vec2(x, y) * texel_size, tile_min, tile_max)).r;
+            shadow += current - bias > pcf_depth ? 1.0 : 0.0;
+        }
+    }
+
+    return shadow / 9.0;
+}
\ No newline at end of file
@@ -0,0 +1,6 @@
+#version 410
+
+void main()
+{
+    
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 410
+
+layout (location = 0) in vec3 pos;
+
+uniform mat4 light_space_transform;
+
+#include "draw_data.glsl"
+
+void main()
+{
+    gl_Position = light_space_transform * draw_model_matrix() * vec4(pos, 1.0);
+}
\ No newline at end of file
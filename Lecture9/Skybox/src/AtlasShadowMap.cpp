@@ -0,0 +1,39 @@
+#include <AtlasShadowMap.hpp>
+
+AtlasShadowMap::AtlasShadowMap(std::shared_ptr<ShadowAtlas> _atlas) noexcept
+    : ShadowMap{}, atlas{_atlas}
+{
+
+}
+
+AtlasShadowMap::~AtlasShadowMap()
+{
+
+}
+
+bool AtlasShadowMap::init(GLuint, GLuint) noexcept
+{
+    // The storage belongs to the atlas, the size comes from set_tile()
+    return true;
+}
+
+void AtlasShadowMap::write() const noexcept
+{
+    atlas->write(tile);
+}
+
+void AtlasShadowMap::read(GLenum texture_unit) noexcept
+{
+    atlas->read(texture_unit);
+}
+
+void AtlasShadowMap::set_tile(const ShadowAtlas::Tile& _tile) noexcept
+{
+    if (_tile != tile)
+    {
+        tile = _tile;
+        width = tile.size;
+        height = tile.size;
+        mark_dirty();
+    }
+}
\ No newline at end of file
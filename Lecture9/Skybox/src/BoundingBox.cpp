@@ -0,0 +1,72 @@
+#include <BoundingBox.hpp>
+
+BoundingBox::BoundingBox(const glm::vec3& _min, const glm::vec3& _max) noexcept
+    : min{_min}, max{_max}
+{
+
+}
+
+void BoundingBox::expand(const glm::vec3& point) noexcept
+{
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+void BoundingBox::expand(const BoundingBox& box) noexcept
+{
+    if (box.is_empty())
+    {
+        return;
+    }
+
+    expand(box.min);
+    expand(box.max);
+}
+
+bool BoundingBox::is_empty() const noexcept
+{
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+BoundingBox BoundingBox::transform(const glm::mat4& matrix) const noexcept
+{
+    BoundingBox result{};
+
+    if (is_empty())
+    {
+        return result;
+    }
+
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner{i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z};
+        result.expand(glm::vec3{matrix * glm::vec4{corner, 1.f}});
+    }
+
+    return result;
+}
+
+bool BoundingBox::intersects(const BoundingBox& box) const noexcept
+{
+    if (is_empty() || box.is_empty())
+    {
+        return false;
+    }
+
+    return min.x <= box.max.x && max.x >= box.min.x &&
+           min.y <= box.max.y && max.y >= box.min.y &&
+           min.z <= box.max.z && max.z >= box.min.z;
+}
+
+bool BoundingBox::intersects_sphere(const glm::vec3& center, GLfloat radius) const noexcept
+{
+    if (is_empty())
+    {
+        return false;
+    }
+
+    glm::vec3 closest = glm::clamp(center, min, max);
+    glm::vec3 offset = closest - center;
+
+    return glm::dot(offset, offset) <= radius * radius;
+}
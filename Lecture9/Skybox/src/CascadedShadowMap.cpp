@@ -0,0 +1,87 @@
+#include <CascadedShadowMap.hpp>
+
+CascadedShadowMap::CascadedShadowMap(GLuint _num_cascades) noexcept
+    : ShadowMap{}, num_cascades{std::max(1u, std::min(GLuint(MAX_CASCADES), _num_cascades))}
+{
+
+}
+
+CascadedShadowMap::~CascadedShadowMap()
+{
+    if (moments_id)
+    {
+        glDeleteTextures(1, &moments_id);
+    }
+}
+
+bool CascadedShadowMap::init(GLuint w, GLuint h) noexcept
+{
+    width = w;
+    height = h;
+
+    glGenFramebuffers(1, &FBO_id);
+
+    glGenTextures(1, &shadow_map_id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, shadow_map_id);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, width, height, num_cascades, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    float border_color[] = {1.f, 1.f, 1.f, 1.f};
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border_color);
+
+    // Layered attachment: the geometry shader picks the cascade with gl_Layer
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO_id);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadow_map_id, 0);
+
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG_INIT_CERR();
+        log(LOG_ERR) << "Framebuffer error: " << status << "\n";
+        return false;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    return true;
+}
+
+void CascadedShadowMap::read(GLenum texture_unit) noexcept
+{
+    glActiveTexture(texture_unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, shadow_map_id);
+}
+
+
+bool CascadedShadowMap::init_moments() noexcept
+{
+    if (moments_id)
+    {
+        return true;
+    }
+
+    glGenTextures(1, &moments_id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, moments_id);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA32F, width, height, num_cascades, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Allocates the whole mip chain
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+    return true;
+}
+
+void CascadedShadowMap::read_moments(GLenum texture_unit) const noexcept
+{
+    glActiveTexture(texture_unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, moments_id);
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include <algorithm>
+
+#include <DepthPyramid.hpp>
+
+DepthPyramid::DepthPyramid(std::shared_ptr<Shader> _reduce_shader) noexcept
+    : reduce_shader{_reduce_shader}
+{
+
+}
+
+DepthPyramid::~DepthPyramid()
+{
+    glDeleteFramebuffers(1, &copy_FBO_id);
+    glDeleteTextures(1, &depth_copy_id);
+    glDeleteTextures(1, &pyramid_id);
+}
+
+bool DepthPyramid::init(GLuint w, GLuint h) noexcept
+{
+    width = w;
+    height = h;
+
+    GLuint level_width = std::max(w / 2, 1u);
+    GLuint level_height = std::max(h / 2, 1u);
+
+    num_levels = 1;
+
+    for (GLuint size = std::max(level_width, level_height); size > 1; size /= 2)
+    {
+        ++num_levels;
+    }
+
+    // Immutable storage, so every level can be bound as an image
+    glGenTextures(1, &pyramid_id);
+    glBindTexture(GL_TEXTURE_2D, pyramid_id);
+    glTexStorage2D(GL_TEXTURE_2D, num_levels, GL_R32F, level_width, level_height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Blits between depth buffers need the same format on both sides
+    glGenTextures(1, &depth_copy_id);
+    glBindTexture(GL_TEXTURE_2D, depth_copy_id);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH24_STENCIL8, w, h);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &copy_FBO_id);
+    glBindFramebuffer(GL_FRAMEBUFFER, copy_FBO_id);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, depth_copy_id, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG_INIT_CERR();
+        log(LOG_ERR) << "Framebuffer error: " << status << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+void DepthPyramid::build_from_window() noexcept
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, copy_FBO_id);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    build(depth_copy_id);
+}
+
+void DepthPyramid::build(GLuint depth_texture_id) noexcept
+{
+    reduce_shader->use();
+
+    glActiveTexture(GL_TEXTURE0);
+
+    GLuint level_width = std::max(width / 2, 1u);
+    GLuint level_height = std::max(height / 2, 1u);
+
+    for (GLint level = 0; level < num_levels; ++level)
+    {
+        // Level 0 reads the depth, every other level the one above it. The
+        // levels read and written never overlap, so one texture serves both.
+        glBindTexture(GL_TEXTURE_2D, level == 0 ? depth_texture_id : pyramid_id);
+        reduce_shader->set_depth_reduction(0, level == 0 ? 0 : level - 1);
+
+        glBindImageTexture(0, pyramid_id, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glDispatchCompute((level_width + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, (level_height + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1);
+
+        // The next level and the culling pass fetch what this one wrote
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+        level_width = std::max(level_width / 2, 1u);
+        level_height = std::max(level_height / 2, 1u);
+    }
+
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    built = true;
+}
+
+void DepthPyramid::read(GLenum texture_unit) const noexcept
+{
+    glActiveTexture(texture_unit);
+    glBindTexture(GL_TEXTURE_2D, pyramid_id);
+}
\ No newline at end of file
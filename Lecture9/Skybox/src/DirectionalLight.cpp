@@ -1,12 +1,20 @@
 #include <DirectionalLight.hpp>
 
-DirectionalLight::DirectionalLight(GLuint shadow_width, GLuint shadow_height,
+DirectionalLight::DirectionalLight(GLuint shadow_width, GLuint shadow_height, GLuint num_cascades,
                                    GLfloat red, GLfloat green, GLfloat blue,
                                    GLfloat _ambient_intensity, GLfloat _diffuse_intensity,
                                    GLfloat x_dir, GLfloat y_dir, GLfloat z_dir) noexcept
-    : Light{shadow_width, shadow_height, red, green, blue, _ambient_intensity, _diffuse_intensity}, direction{x_dir, y_dir, z_dir}
+    : Light{red, green, blue, _ambient_intensity, _diffuse_intensity}, direction{x_dir, y_dir, z_dir}
 {
-    projection = glm::ortho(-20.0f, 20.0f, -20.0f, 20.0f, 0.1f, 100.0f);
+    // The lighting shader takes the direction as given
+    direction = glm::normalize(direction);
+
+    auto cascaded_shadow_map = std::make_shared<CascadedShadowMap>(num_cascades);
+    cascaded_shadow_map->init(shadow_width, shadow_height);
+    shadow_map = cascaded_shadow_map;
+
+    light_transforms.resize(cascaded_shadow_map->get_num_cascades(), glm::mat4{1.f});
+    cascade_splits.resize(cascaded_shadow_map->get_num_cascades(), 0.f);
 }
 
 DirectionalLight::~DirectionalLight()
@@ -20,7 +28,98 @@ void DirectionalLight::use(GLuint color_id, GLuint ambient_intensity_id, GLuint
     glUniform3f(direction_id, direction.x, direction.y, direction.z);
 }
 
+void DirectionalLight::update_cascades(const glm::mat4& view, GLfloat fov, GLfloat aspect, GLfloat near, GLfloat far) noexcept
+{
+    size_t num_cascades = light_transforms.size();
+    GLfloat split_near = near;
+
+    for (size_t i = 0; i < num_cascades; ++i)
+    {
+        GLfloat p = GLfloat(i + 1) / GLfloat(num_cascades);
+        GLfloat log_split = near * std::pow(far / near, p);
+        GLfloat uniform_split = near + (far - near) * p;
+        GLfloat split_far = SPLIT_LAMBDA * log_split + (1.f - SPLIT_LAMBDA) * uniform_split;
+
+        glm::mat4 light_transform = fit_cascade(view, fov, aspect, split_near, split_far);
+
+        if (light_transform != light_transforms[i])
+        {
+            light_transforms[i] = light_transform;
+            shadow_map->mark_dirty();
+        }
+
+        cascade_splits[i] = split_far;
+        split_near = split_far;
+    }
+}
+
 glm::mat4 DirectionalLight::get_light_transform() const noexcept
 {
-    return projection * glm::lookAt(-direction, glm::vec3{0.f, 0.f, 0.f}, glm::vec3{0.f, 1.f, 0.f});
-}
\ No newline at end of file
+    return light_transforms.empty() ? glm::mat4{1.f} : light_transforms.front();
+}
+
+bool DirectionalLight::shadow_volume_intersects(const BoundingBox& bounds) const noexcept
+{
+    // Depth clamping keeps casters in front of the near plane, so only the far plane limits z
+    BoundingBox cascade_volume{glm::vec3{-1.f, -1.f, std::numeric_limits<GLfloat>::lowest()}, glm::vec3{1.f, 1.f, 1.f}};
+
+    for (const auto& light_transform: light_transforms)
+    {
+        if (bounds.transform(light_transform).intersects(cascade_volume))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+glm::mat4 DirectionalLight::fit_cascade(const glm::mat4& view, GLfloat fov, GLfloat aspect, GLfloat near, GLfloat far) const noexcept
+{
+    glm::mat4 inverse_view_projection = glm::inverse(glm::perspective(fov, aspect, near, far) * view);
+
+    std::vector<glm::vec3> corners;
+    glm::vec3 center{0.f, 0.f, 0.f};
+
+    for (float x: {-1.f, 1.f})
+    {
+        for (float y: {-1.f, 1.f})
+        {
+            for (float z: {-1.f, 1.f})
+            {
+                glm::vec4 corner = inverse_view_projection * glm::vec4{x, y, z, 1.f};
+                corners.push_back(glm::vec3{corner} / corner.w);
+                center += corners.back();
+            }
+        }
+    }
+
+    center /= GLfloat(corners.size());
+
+    // A bounding sphere keeps the projection size constant while the camera rotates
+    GLfloat radius = 0.f;
+
+    for (const auto& corner: corners)
+    {
+        radius = std::max(radius, glm::length(corner - center));
+    }
+
+    radius = std::ceil(radius * 16.f) / 16.f;
+
+    glm::vec3 light_direction = glm::normalize(direction);
+    glm::vec3 up = std::abs(light_direction.y) > 0.99f ? glm::vec3{0.f, 0.f, 1.f} : glm::vec3{0.f, 1.f, 0.f};
+
+    // Casters between the light and the slice are kept by the negative near plane
+    glm::mat4 light_view = glm::lookAt(center - light_direction * radius, center, up);
+    glm::mat4 light_projection = glm::ortho(-radius, radius, -radius, radius, -radius * 4.f, radius * 2.f);
+
+    // Snap the origin to whole texels so edges do not shimmer when the camera moves
+    glm::vec4 origin = light_projection * light_view * glm::vec4{0.f, 0.f, 0.f, 1.f};
+    GLfloat half_size = GLfloat(shadow_map->get_width()) * 0.5f;
+    glm::vec2 texel_origin = glm::vec2{origin.x, origin.y} * half_size;
+    glm::vec2 offset = (glm::round(texel_origin) - texel_origin) / half_size;
+    light_projection[3][0] += offset.x;
+    light_projection[3][1] += offset.y;
+
+    return light_projection * light_view;
+}
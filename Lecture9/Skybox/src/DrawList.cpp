@@ -0,0 +1,387 @@
+#include <algorithm>
+
+#include <DrawList.hpp>
+#include <GpuCulling.hpp>
+
+DrawList::~DrawList()
+{
+    for (auto& buffer: buffers)
+    {
+        glDeleteTextures(1, &buffer.texture_id);
+        glDeleteBuffers(1, &buffer.buffer_id);
+    }
+
+    glDeleteBuffers(1, &indirect_buffer_id);
+}
+
+bool DrawList::init() noexcept
+{
+    for (auto& buffer: buffers)
+    {
+        glGenBuffers(1, &buffer.buffer_id);
+        glGenTextures(1, &buffer.texture_id);
+
+        if (buffer.buffer_id == 0 || buffer.texture_id == 0)
+        {
+            LOG_INIT_CERR();
+            log(LOG_ERR) << "Could not create the draw data buffers\n";
+            return false;
+        }
+    }
+
+    pool = GeometryPool::get_instance();
+
+    // The base instance carries the draw ID, so indirect draws need it as well
+    multi_draw_indirect = GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance);
+
+    if (multi_draw_indirect)
+    {
+        glGenBuffers(1, &indirect_buffer_id);
+    }
+
+    LOG_INIT_COUT();
+    log(LOG_INFO) << "Depth-only submission: " << (multi_draw_indirect ? "glMultiDrawElementsIndirect" : "glMultiDrawElementsBaseVertex") << "\n";
+
+    return true;
+}
+
+void DrawList::add(std::shared_ptr<Mesh> mesh, std::shared_ptr<Texture> texture, std::shared_ptr<Material> material, const glm::mat4& model, unsigned flags) noexcept
+{
+    Item item;
+    item.model = model;
+    item.bounds = mesh->get_bounds().transform(model);
+    item.mesh = mesh;
+    item.texture = texture;
+    item.material = material;
+    item.occluder = (flags & OCCLUDER) != 0;
+    item.is_static = (flags & STATIC) != 0;
+
+    items.push_back(item);
+}
+
+void DrawList::add(std::shared_ptr<Model> scene_model, std::shared_ptr<Material> material, const glm::mat4& model, unsigned flags) noexcept
+{
+    Item item;
+    item.model = model;
+    item.bounds = scene_model->get_bounds().transform(model);
+    item.scene_model = scene_model;
+    item.material = material;
+    item.occluder = (flags & OCCLUDER) != 0;
+    item.is_static = (flags & STATIC) != 0;
+
+    items.push_back(item);
+}
+
+void DrawList::upload(const std::vector<GLuint>& face_masks) noexcept
+{
+    draw_data.resize(std::max<size_t>(items.size(), 1) * TEXELS_PER_DRAW);
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const Item& item = items[i];
+        glm::vec4* texels = &draw_data[i * TEXELS_PER_DRAW];
+        glm::mat3 normal_matrix = glm::transpose(glm::inverse(glm::mat3{item.model}));
+
+        for (int column = 0; column < 4; ++column)
+        {
+            texels[column] = item.model[column];
+        }
+
+        for (int column = 0; column < 3; ++column)
+        {
+            texels[4 + column] = glm::vec4{normal_matrix[column], 0.f};
+        }
+
+        texels[7] = item.material ? glm::vec4{item.material->get_specular_intensity(), item.material->get_shininess(), 0.f, 0.f} : glm::vec4{0.f};
+
+        // Exact as a float, a mask has six bits
+        texels[7].z = i < face_masks.size() ? GLfloat(face_masks[i]) : 0.f;
+    }
+
+    current_buffer = (current_buffer + 1) % NUM_BUFFERED_FRAMES;
+    TextureBuffer& buffer = buffers[current_buffer];
+    size_t size = draw_data.size() * sizeof(glm::vec4);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer.buffer_id);
+
+    if (size > buffer.capacity)
+    {
+        buffer.capacity = std::max<size_t>(2 * size, 4096);
+        glBufferData(GL_TEXTURE_BUFFER, buffer.capacity, nullptr, GL_DYNAMIC_DRAW);
+
+        glBindTexture(GL_TEXTURE_BUFFER, buffer.texture_id);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer.buffer_id);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // NUM_BUFFERED_FRAMES uploads after its last use, the GPU is usually done with this buffer.
+    // Layered shadow lights upload more than once a frame, then GL orders the write after their draws.
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, size, draw_data.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    if (multi_draw_indirect)
+    {
+        pool->set_draw_ids(DRAW_ID_ATTRIBUTE, DRAW_ID_DIVISOR, items.size());
+    }
+}
+
+void DrawList::read(GLenum texture_unit) const noexcept
+{
+    glActiveTexture(texture_unit);
+    glBindTexture(GL_TEXTURE_BUFFER, buffers[current_buffer].texture_id);
+}
+
+void DrawList::render(std::string_view pass, const DrawFilter& filter, Mode mode) noexcept
+{
+    auto cpu_start = std::chrono::steady_clock::now();
+
+    size_t draw_calls = 0;
+    size_t num_commands = 0;
+
+    // Consecutive items often share it, binding once is enough
+    const Texture* bound_texture = nullptr;
+
+    commands.clear();
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const Item& item = items[i];
+        GLsizei instance_count = filter ? filter(item.bounds, i) : 1;
+
+        if (instance_count <= 0)
+        {
+            continue;
+        }
+
+        const std::shared_ptr<Mesh>* meshes = item.mesh ? &item.mesh : item.scene_model->get_meshes().data();
+        size_t num_meshes = item.mesh ? 1 : item.scene_model->get_meshes().size();
+        num_commands += num_meshes;
+
+        if (mode == Mode::DEPTH)
+        {
+            for (size_t m = 0; m < num_meshes; ++m)
+            {
+                const auto& mesh = meshes[m];
+
+                if (mesh->has_position_stream())
+                {
+                    const GeometryPool::Range& range = mesh->get_position_range();
+                    commands.push_back(DrawCommand{range.index_count, GLuint(instance_count), range.first_index, range.base_vertex, GLuint(i)});
+                }
+                else
+                {
+                    glVertexAttribI1i(DRAW_ID_ATTRIBUTE, GLint(i));
+                    mesh->render_positions(instance_count);
+                    ++draw_calls;
+                }
+            }
+
+            continue;
+        }
+
+        // Current vertex state rather than a uniform, no VAO of a mesh enables this attribute
+        glVertexAttribI1i(DRAW_ID_ATTRIBUTE, GLint(i));
+        draw_calls += num_meshes;
+
+        if (mode == Mode::DEPTH_UNBATCHED)
+        {
+            for (size_t m = 0; m < num_meshes; ++m)
+            {
+                meshes[m]->render_positions(instance_count);
+            }
+
+            continue;
+        }
+
+        if (item.texture && item.texture.get() != bound_texture)
+        {
+            item.texture->use();
+            bound_texture = item.texture.get();
+        }
+
+        if (item.mesh)
+        {
+            item.mesh->render(instance_count);
+        }
+        else
+        {
+            item.scene_model->render(instance_count);
+
+            // The model bound textures of its own
+            bound_texture = nullptr;
+        }
+    }
+
+    if (!commands.empty())
+    {
+        draw_calls += submit(commands);
+    }
+
+    add_stats(pass, draw_calls, num_commands, cpu_start);
+}
+
+void DrawList::render_culled(std::string_view pass, const GpuCulling& culling, const DrawFilter& filter) noexcept
+{
+    auto cpu_start = std::chrono::steady_clock::now();
+
+    size_t draw_calls = 0;
+    size_t num_commands = culling.get_num_objects();
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const Item& item = items[i];
+        const std::shared_ptr<Mesh>* meshes = item.mesh ? &item.mesh : item.scene_model->get_meshes().data();
+        size_t num_meshes = item.mesh ? 1 : item.scene_model->get_meshes().size();
+
+        for (size_t m = 0; m < num_meshes; ++m)
+        {
+            const auto& mesh = meshes[m];
+
+            if (mesh->has_position_stream() || (filter && filter(item.bounds, i) <= 0))
+            {
+                continue;
+            }
+
+            glVertexAttribI1i(DRAW_ID_ATTRIBUTE, GLint(i));
+            mesh->render_positions(1);
+            ++draw_calls;
+            ++num_commands;
+        }
+    }
+
+    culling.draw();
+    ++draw_calls;
+
+    add_stats(pass, draw_calls, num_commands, cpu_start);
+}
+
+size_t DrawList::draw_item(size_t index, Mode mode) noexcept
+{
+    const Item& item = items[index];
+    const std::shared_ptr<Mesh>* meshes = item.mesh ? &item.mesh : item.scene_model->get_meshes().data();
+    size_t num_meshes = item.mesh ? 1 : item.scene_model->get_meshes().size();
+
+    glVertexAttribI1i(DRAW_ID_ATTRIBUTE, GLint(index));
+
+    if (mode != Mode::SHADED)
+    {
+        for (size_t m = 0; m < num_meshes; ++m)
+        {
+            meshes[m]->render_positions(1);
+        }
+
+        return num_meshes;
+    }
+
+    if (item.texture)
+    {
+        item.texture->use();
+    }
+
+    if (item.mesh)
+    {
+        item.mesh->render(1);
+    }
+    else
+    {
+        item.scene_model->render(1);
+    }
+
+    return num_meshes;
+}
+
+size_t DrawList::submit(const std::vector<DrawCommand>& draw_commands) noexcept
+{
+    if (multi_draw_indirect)
+    {
+        // Respecifying the store orphans what an earlier pass of the frame may still be reading
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer_id);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, draw_commands.size() * sizeof(DrawCommand), draw_commands.data(), GL_STREAM_DRAW);
+
+        pool->bind_indirect();
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, GLsizei(draw_commands.size()), 0);
+        glBindVertexArray(0);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+        return 1;
+    }
+
+    size_t draw_calls = 0;
+
+    pool->bind();
+
+    // Without base instances the draw ID is per call, so the runs of one item go together
+    for (size_t begin = 0; begin < draw_commands.size();)
+    {
+        const DrawCommand& first = draw_commands[begin];
+        glVertexAttribI1i(DRAW_ID_ATTRIBUTE, GLint(first.base_instance));
+        ++draw_calls;
+
+        if (first.instance_count != 1)
+        {
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, first.count, GL_UNSIGNED_INT,
+                                              reinterpret_cast<const void*>(first.first_index * sizeof(unsigned int)),
+                                              first.instance_count, first.base_vertex);
+            ++begin;
+            continue;
+        }
+
+        counts.clear();
+        offsets.clear();
+        base_vertices.clear();
+
+        size_t end = begin;
+
+        for (; end < draw_commands.size() && draw_commands[end].base_instance == first.base_instance && draw_commands[end].instance_count == 1; ++end)
+        {
+            counts.push_back(draw_commands[end].count);
+            offsets.push_back(reinterpret_cast<const void*>(draw_commands[end].first_index * sizeof(unsigned int)));
+            base_vertices.push_back(draw_commands[end].base_vertex);
+        }
+
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts.data(), GL_UNSIGNED_INT, offsets.data(), GLsizei(counts.size()), base_vertices.data());
+        begin = end;
+    }
+
+    glBindVertexArray(0);
+
+    return draw_calls;
+}
+
+void DrawList::add_stats(std::string_view pass, size_t draw_calls, size_t num_commands, std::chrono::steady_clock::time_point cpu_start) noexcept
+{
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - cpu_start;
+
+    auto it = pass_stats.find(pass);
+
+    if (it == pass_stats.end())
+    {
+        it = pass_stats.emplace(std::string{pass}, PassStats{}).first;
+    }
+
+    it->second.draw_calls += draw_calls;
+    it->second.commands += num_commands;
+    it->second.cpu_ms += elapsed.count();
+}
+
+void DrawList::end_frame() noexcept
+{
+    if (++num_frames < REPORT_INTERVAL)
+    {
+        return;
+    }
+
+    LOG_INIT_COUT();
+
+    for (auto& [pass, stats]: pass_stats)
+    {
+        log(LOG_INFO) << pass << ": " << double(stats.draw_calls) / num_frames << " draw calls, "
+                      << double(stats.commands) / num_frames << " meshes, CPU " << stats.cpu_ms / num_frames << " ms per frame ("
+                      << (multi_draw_indirect ? "indirect" : "base vertex") << ")\n";
+
+        stats = PassStats{};
+    }
+
+    num_frames = 0;
+}
\ No newline at end of file
@@ -0,0 +1,469 @@
+#include <algorithm>
+
+#include <FrameGraph.hpp>
+
+FrameGraph::Resource FrameGraph::Builder::create(std::string_view name, const TextureDesc& desc) noexcept
+{
+    ResourceNode resource;
+    resource.name = name;
+    resource.desc = desc;
+
+    graph.resources.push_back(resource);
+
+    return write(graph.resources.size() - 1);
+}
+
+FrameGraph::Resource FrameGraph::Builder::read(Resource resource) noexcept
+{
+    graph.passes[pass].reads.push_back(resource);
+
+    return resource;
+}
+
+FrameGraph::Resource FrameGraph::Builder::write(Resource resource) noexcept
+{
+    graph.passes[pass].writes.push_back(resource);
+    graph.resources[resource].writers.push_back(pass);
+
+    return resource;
+}
+
+void FrameGraph::Builder::side_effects() noexcept
+{
+    graph.passes[pass].side_effects = true;
+}
+
+FrameGraph::~FrameGraph()
+{
+    for (const auto& [attachments, framebuffer_id]: framebuffers)
+    {
+        glDeleteFramebuffers(1, &framebuffer_id);
+    }
+
+    for (const auto& texture: pool)
+    {
+        glDeleteTextures(1, &texture.texture_id);
+    }
+}
+
+FrameGraph::Resource FrameGraph::import_resource(std::string_view name, GLint framebuffer) noexcept
+{
+    ResourceNode resource;
+    resource.name = name;
+    resource.imported = true;
+    resource.framebuffer = framebuffer;
+
+    resources.push_back(resource);
+
+    return resources.size() - 1;
+}
+
+void FrameGraph::add_pass(std::string_view name, const Setup& setup, Execute execute) noexcept
+{
+    PassNode pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+
+    passes.push_back(pass);
+
+    Builder builder{*this, passes.size() - 1};
+    setup(builder);
+}
+
+void FrameGraph::compile() noexcept
+{
+    cull();
+
+    for (size_t i = 0; i < passes.size(); ++i)
+    {
+        if (passes[i].culled)
+        {
+            continue;
+        }
+
+        auto use = [this, i](Resource r) {
+            ResourceNode& resource = resources[r];
+
+            if (!resource.used)
+            {
+                resource.first_pass = i;
+                resource.used = true;
+            }
+
+            resource.last_pass = i;
+        };
+
+        std::for_each(passes[i].reads.begin(), passes[i].reads.end(), use);
+        std::for_each(passes[i].writes.begin(), passes[i].writes.end(), use);
+    }
+
+    // Walking the passes in order, a texture released after a pass can be
+    // acquired again before the next one: lifetimes that do not overlap alias
+    for (size_t i = 0; i < passes.size(); ++i)
+    {
+        for (auto& resource: resources)
+        {
+            if (resource.used && !resource.imported && resource.first_pass == i)
+            {
+                resource.texture_id = acquire(resource.desc);
+                ++num_transients;
+            }
+        }
+
+        for (const auto& resource: resources)
+        {
+            if (resource.used && !resource.imported && resource.last_pass == i)
+            {
+                release(resource.texture_id);
+            }
+        }
+    }
+}
+
+void FrameGraph::cull() noexcept
+{
+    for (auto& pass: passes)
+    {
+        pass.ref_count = pass.writes.size();
+
+        for (Resource r: pass.reads)
+        {
+            ++resources[r].ref_count;
+        }
+    }
+
+    // Passes writing nothing go first. The scan below finds the inputs they leave
+    // unread, so every resource is queued once, when its count reaches zero.
+    for (auto& pass: passes)
+    {
+        if (pass.ref_count == 0 && !pass.side_effects)
+        {
+            pass.culled = true;
+
+            for (Resource r: pass.reads)
+            {
+                --resources[r].ref_count;
+            }
+        }
+    }
+
+    std::vector<Resource> unreferenced;
+
+    auto cull_pass = [this, &unreferenced](PassNode& pass) {
+        pass.culled = true;
+
+        for (Resource r: pass.reads)
+        {
+            if (--resources[r].ref_count == 0)
+            {
+                unreferenced.push_back(r);
+            }
+        }
+    };
+
+    for (Resource r = 0; r < resources.size(); ++r)
+    {
+        if (resources[r].ref_count == 0)
+        {
+            unreferenced.push_back(r);
+        }
+    }
+
+    // A pass goes once nothing reads any of its outputs, which may leave its own inputs unread
+    while (!unreferenced.empty())
+    {
+        Resource r = unreferenced.back();
+        unreferenced.pop_back();
+
+        for (size_t writer: resources[r].writers)
+        {
+            PassNode& pass = passes[writer];
+
+            if (!pass.culled && --pass.ref_count == 0 && !pass.side_effects)
+            {
+                cull_pass(pass);
+            }
+        }
+    }
+}
+
+void FrameGraph::execute() noexcept
+{
+    for (const auto& pass: passes)
+    {
+        ++num_passes;
+
+        if (pass.culled)
+        {
+            ++num_culled;
+            continue;
+        }
+
+        bind_targets(pass);
+        pass.execute(*this);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    bound_framebuffer = OWN_FRAMEBUFFER;
+
+    passes.clear();
+    resources.clear();
+
+    trim_pool();
+    ++frame;
+
+    if (++num_frames < REPORT_INTERVAL)
+    {
+        return;
+    }
+
+    size_t pool_bytes = 0;
+
+    for (const auto& texture: pool)
+    {
+        pool_bytes += size_t(texture.desc.width) * texture.desc.height * get_bytes_per_texel(texture.desc.internal_format);
+    }
+
+    LOG_INIT_COUT();
+    log(LOG_INFO) << "Frame graph: " << double(num_passes - num_culled) / num_frames << " of " << double(num_passes) / num_frames << " passes run, "
+                  << double(num_transients) / num_frames << " transient targets in " << pool.size() << " pooled textures (" << pool_bytes / (1024 * 1024) << " MiB), "
+                  << double(num_bindings) / num_frames << " framebuffer bindings per frame\n";
+
+    num_frames = 0;
+    num_passes = 0;
+    num_culled = 0;
+    num_transients = 0;
+    num_bindings = 0;
+}
+
+void FrameGraph::copy_depth(Resource source, GLint framebuffer) noexcept
+{
+    const ResourceNode& resource = resources[source];
+    GLuint source_framebuffer = get_framebuffer({}, resource.texture_id, resource.desc.internal_format == GL_DEPTH24_STENCIL8);
+    GLint width = resource.desc.width;
+    GLint height = resource.desc.height;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, source_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    bound_framebuffer = framebuffer;
+    ++num_bindings;
+}
+
+GLuint FrameGraph::acquire(const TextureDesc& desc) noexcept
+{
+    for (auto& texture: pool)
+    {
+        if (!texture.in_use && texture.desc == desc)
+        {
+            texture.in_use = true;
+            texture.last_frame = frame;
+            return texture.texture_id;
+        }
+    }
+
+    PooledTexture texture;
+    texture.desc = desc;
+    texture.in_use = true;
+    texture.last_frame = frame;
+
+    // The targets are read with texelFetch or one texel per pixel, nothing to filter
+    glGenTextures(1, &texture.texture_id);
+    glBindTexture(GL_TEXTURE_2D, texture.texture_id);
+
+    if (desc.internal_format == GL_DEPTH24_STENCIL8)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, desc.internal_format, desc.width, desc.height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
+    }
+    else if (is_depth_format(desc.internal_format))
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, desc.internal_format, desc.width, desc.height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    }
+    else
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, desc.internal_format, desc.width, desc.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    pool.push_back(texture);
+
+    return texture.texture_id;
+}
+
+void FrameGraph::release(GLuint texture_id) noexcept
+{
+    for (auto& texture: pool)
+    {
+        if (texture.texture_id == texture_id)
+        {
+            texture.in_use = false;
+        }
+    }
+}
+
+void FrameGraph::trim_pool() noexcept
+{
+    auto expired = [this](const PooledTexture& texture) { return texture.last_frame + POOL_FRAMES < frame; };
+
+    for (const auto& texture: pool)
+    {
+        if (!expired(texture))
+        {
+            continue;
+        }
+
+        for (auto it = framebuffers.begin(); it != framebuffers.end();)
+        {
+            if (std::find(it->first.begin(), it->first.end(), texture.texture_id) != it->first.end())
+            {
+                glDeleteFramebuffers(1, &it->second);
+                it = framebuffers.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        glDeleteTextures(1, &texture.texture_id);
+    }
+
+    pool.erase(std::remove_if(pool.begin(), pool.end(), expired), pool.end());
+}
+
+void FrameGraph::bind_targets(const PassNode& pass) noexcept
+{
+    std::vector<GLuint> color_ids;
+    GLuint depth_id = 0;
+    bool depth_stencil = false;
+    GLuint width = 0;
+    GLuint height = 0;
+    GLint framebuffer = OWN_FRAMEBUFFER;
+
+    for (Resource r: pass.writes)
+    {
+        const ResourceNode& resource = resources[r];
+
+        if (resource.imported)
+        {
+            framebuffer = resource.framebuffer;
+            continue;
+        }
+
+        if (is_depth_format(resource.desc.internal_format))
+        {
+            depth_id = resource.texture_id;
+            depth_stencil = resource.desc.internal_format == GL_DEPTH24_STENCIL8;
+        }
+        else
+        {
+            color_ids.push_back(resource.texture_id);
+        }
+
+        width = resource.desc.width;
+        height = resource.desc.height;
+    }
+
+    if (!color_ids.empty() || depth_id != 0)
+    {
+        framebuffer = GLint(get_framebuffer(color_ids, depth_id, depth_stencil));
+        glViewport(0, 0, width, height);
+    }
+    else if (framebuffer == OWN_FRAMEBUFFER)
+    {
+        // Whatever the pass binds is unknown to the next one
+        bound_framebuffer = OWN_FRAMEBUFFER;
+        return;
+    }
+
+    if (framebuffer != bound_framebuffer)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        bound_framebuffer = framebuffer;
+        ++num_bindings;
+    }
+}
+
+GLuint FrameGraph::get_framebuffer(const std::vector<GLuint>& color_ids, GLuint depth_id, bool depth_stencil) noexcept
+{
+    std::vector<GLuint> attachments{color_ids};
+    attachments.push_back(depth_id);
+
+    auto it = framebuffers.find(attachments);
+
+    if (it != framebuffers.end())
+    {
+        return it->second;
+    }
+
+    GLuint framebuffer_id = 0;
+    glGenFramebuffers(1, &framebuffer_id);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+
+    std::vector<GLenum> draw_buffers;
+
+    for (size_t i = 0; i < color_ids.size(); ++i)
+    {
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, color_ids[i], 0);
+        draw_buffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+    }
+
+    if (depth_id != 0)
+    {
+        glFramebufferTexture(GL_FRAMEBUFFER, depth_stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, depth_id, 0);
+    }
+
+    if (draw_buffers.empty())
+    {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    else
+    {
+        glDrawBuffers(draw_buffers.size(), draw_buffers.data());
+    }
+
+    auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG_INIT_CERR();
+        log(LOG_ERR) << "Framebuffer error: " << status << "\n";
+    }
+
+    // The caller binds it again, which the tracking must see
+    bound_framebuffer = OWN_FRAMEBUFFER;
+    framebuffers.emplace(attachments, framebuffer_id);
+
+    return framebuffer_id;
+}
+
+bool FrameGraph::is_depth_format(GLenum internal_format) noexcept
+{
+    return internal_format == GL_DEPTH_COMPONENT16 || internal_format == GL_DEPTH_COMPONENT24 || internal_format == GL_DEPTH_COMPONENT32F ||
+           internal_format == GL_DEPTH24_STENCIL8;
+}
+
+size_t FrameGraph::get_bytes_per_texel(GLenum internal_format) noexcept
+{
+    switch (internal_format)
+    {
+        case GL_DEPTH_COMPONENT16:
+            return 2;
+
+        case GL_RGBA16F:
+            return 8;
+
+        case GL_RGBA32F:
+            return 16;
+
+        default:
+            return 4;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include <Frustum.hpp>
+
+Frustum::Frustum(const glm::mat4& view_projection) noexcept
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        glm::vec4 row{view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]};
+        glm::vec4 w_row{view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]};
+
+        planes[i * 2] = w_row + row;
+        planes[i * 2 + 1] = w_row - row;
+    }
+}
+
+bool Frustum::intersects(const BoundingBox& bounds) const noexcept
+{
+    if (bounds.is_empty())
+    {
+        return false;
+    }
+
+    for (const auto& plane: planes)
+    {
+        // Corner of the box farthest along the plane normal
+        glm::vec3 corner{
+            plane.x >= 0.f ? bounds.get_max().x : bounds.get_min().x,
+            plane.y >= 0.f ? bounds.get_max().y : bounds.get_min().y,
+            plane.z >= 0.f ? bounds.get_max().z : bounds.get_min().z
+        };
+
+        if (glm::dot(glm::vec3{plane}, corner) + plane.w < 0.f)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,28 @@
+#include <GBuffer.hpp>
+
+GBuffer GBuffer::create(FrameGraph::Builder& builder, GLuint w, GLuint h) noexcept
+{
+    GBuffer gbuffer;
+    gbuffer.albedo_specular = builder.create("G-buffer albedo and specular", {w, h, GL_RGBA8});
+    gbuffer.normal_shininess = builder.create("G-buffer normal and shininess", {w, h, GL_RGB10_A2});
+    gbuffer.depth = builder.create("G-buffer depth", {w, h, GL_DEPTH_COMPONENT24});
+
+    return gbuffer;
+}
+
+void GBuffer::declare_reads(FrameGraph::Builder& builder) const noexcept
+{
+    builder.read(albedo_specular);
+    builder.read(normal_shininess);
+    builder.read(depth);
+}
+
+void GBuffer::read(const FrameGraph& graph, GLenum albedo_specular_texture_unit, GLenum normal_shininess_texture_unit, GLenum depth_texture_unit) const noexcept
+{
+    glActiveTexture(albedo_specular_texture_unit);
+    glBindTexture(GL_TEXTURE_2D, graph.get_texture(albedo_specular));
+    glActiveTexture(normal_shininess_texture_unit);
+    glBindTexture(GL_TEXTURE_2D, graph.get_texture(normal_shininess));
+    glActiveTexture(depth_texture_unit);
+    glBindTexture(GL_TEXTURE_2D, graph.get_texture(depth));
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <numeric>
+
+#include <GeometryPool.hpp>
+
+std::weak_ptr<GeometryPool> GeometryPool::instance{};
+
+std::shared_ptr<GeometryPool> GeometryPool::get_instance() noexcept
+{
+    auto pool = instance.lock();
+
+    if (!pool)
+    {
+        pool = std::make_shared<GeometryPool>();
+        instance = pool;
+    }
+
+    return pool;
+}
+
+GeometryPool::GeometryPool() noexcept
+{
+    glGenVertexArrays(1, &VAO_id);
+    glGenVertexArrays(1, &indirect_VAO_id);
+
+    glGenBuffers(1, &VBO_id);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_id);
+    glBufferData(GL_ARRAY_BUFFER, vertex_capacity * 3 * sizeof(GLfloat), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenBuffers(1, &IBO_id);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, IBO_id);
+    glBufferData(GL_COPY_WRITE_BUFFER, index_capacity * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    attach(VAO_id);
+    attach(indirect_VAO_id);
+}
+
+GeometryPool::~GeometryPool()
+{
+    glDeleteBuffers(1, &draw_id_buffer_id);
+    glDeleteBuffers(1, &IBO_id);
+    glDeleteBuffers(1, &VBO_id);
+    glDeleteVertexArrays(1, &indirect_VAO_id);
+    glDeleteVertexArrays(1, &VAO_id);
+}
+
+GeometryPool::Range GeometryPool::add(const std::vector<GLfloat>& positions, const std::vector<unsigned int>& indices) noexcept
+{
+    size_t vertex_count = positions.size() / 3;
+
+    if (num_vertices + vertex_count > vertex_capacity || num_indices + indices.size() > index_capacity)
+    {
+        size_t new_vertex_capacity = std::max(vertex_capacity, 2 * (num_vertices + vertex_count));
+        size_t new_index_capacity = std::max(index_capacity, 2 * (num_indices + indices.size()));
+
+        if (new_vertex_capacity != vertex_capacity)
+        {
+            grow(VBO_id, num_vertices * 3 * sizeof(GLfloat), new_vertex_capacity * 3 * sizeof(GLfloat));
+            vertex_capacity = new_vertex_capacity;
+        }
+
+        if (new_index_capacity != index_capacity)
+        {
+            grow(IBO_id, num_indices * sizeof(unsigned int), new_index_capacity * sizeof(unsigned int));
+            index_capacity = new_index_capacity;
+        }
+
+        attach(VAO_id);
+        attach(indirect_VAO_id);
+    }
+
+    Range range{GLuint(num_indices), GLuint(indices.size()), GLint(num_vertices)};
+
+    // Neither buffer is written through the VAO, so no VAO binding gets disturbed
+    glBindBuffer(GL_COPY_WRITE_BUFFER, VBO_id);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, num_vertices * 3 * sizeof(GLfloat), positions.size() * sizeof(GLfloat), positions.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, IBO_id);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, num_indices * sizeof(unsigned int), indices.size() * sizeof(unsigned int), indices.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    num_vertices += vertex_count;
+    num_indices += indices.size();
+
+    return range;
+}
+
+void GeometryPool::grow(GLuint& buffer_id, size_t used, size_t capacity) noexcept
+{
+    GLuint new_buffer_id{0};
+    glGenBuffers(1, &new_buffer_id);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, new_buffer_id);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+
+    if (used > 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer_id);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &buffer_id);
+    buffer_id = new_buffer_id;
+}
+
+void GeometryPool::attach(GLuint vertex_array_id) noexcept
+{
+    glBindVertexArray(vertex_array_id);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO_id);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_id);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3, nullptr);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindVertexArray(0);
+}
+
+void GeometryPool::bind() const noexcept
+{
+    glBindVertexArray(VAO_id);
+}
+
+void GeometryPool::bind_indirect() const noexcept
+{
+    glBindVertexArray(indirect_VAO_id);
+}
+
+void GeometryPool::set_draw_ids(GLuint attribute, GLuint divisor, size_t count) noexcept
+{
+    if (count <= num_draw_ids)
+    {
+        return;
+    }
+
+    num_draw_ids = std::max<size_t>(2 * count, 256);
+
+    std::vector<GLint> draw_ids(num_draw_ids);
+    std::iota(draw_ids.begin(), draw_ids.end(), 0);
+
+    if (draw_id_buffer_id == 0)
+    {
+        glGenBuffers(1, &draw_id_buffer_id);
+    }
+
+    glBindVertexArray(indirect_VAO_id);
+
+    glBindBuffer(GL_ARRAY_BUFFER, draw_id_buffer_id);
+    glBufferData(GL_ARRAY_BUFFER, draw_ids.size() * sizeof(GLint), draw_ids.data(), GL_STATIC_DRAW);
+    glVertexAttribIPointer(attribute, 1, GL_INT, sizeof(GLint), nullptr);
+    glVertexAttribDivisor(attribute, divisor);
+    glEnableVertexAttribArray(attribute);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindVertexArray(0);
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include <algorithm>
+
+#include <GpuCulling.hpp>
+
+GpuCulling::GpuCulling(std::shared_ptr<Shader> _cull_shader) noexcept
+    : cull_shader{_cull_shader}
+{
+
+}
+
+GpuCulling::~GpuCulling()
+{
+    glDeleteBuffers(1, &objects_buffer_id);
+    glDeleteBuffers(1, &commands_buffer_id);
+    glDeleteBuffers(1, &draw_count_buffer_id);
+}
+
+bool GpuCulling::init() noexcept
+{
+    glGenBuffers(1, &objects_buffer_id);
+    glGenBuffers(1, &commands_buffer_id);
+    glGenBuffers(1, &draw_count_buffer_id);
+
+    if (objects_buffer_id == 0 || commands_buffer_id == 0 || draw_count_buffer_id == 0)
+    {
+        LOG_INIT_CERR();
+        log(LOG_ERR) << "Could not create the culling buffers\n";
+        return false;
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, draw_count_buffer_id);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    pool = GeometryPool::get_instance();
+    indirect_count = GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters;
+
+    LOG_INIT_COUT();
+    log(LOG_INFO) << "GPU culling submission: " << (indirect_count ? "glMultiDrawElementsIndirectCount" : "glMultiDrawElementsIndirect over every object") << "\n";
+
+    return true;
+}
+
+void GpuCulling::update(const DrawList& draw_list, const DrawFilter& filter) noexcept
+{
+    objects.clear();
+
+    const auto& items = draw_list.get_items();
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const DrawList::Item& item = items[i];
+
+        if (filter && filter(item.bounds, i) <= 0)
+        {
+            continue;
+        }
+
+        const std::shared_ptr<Mesh>* meshes = item.mesh ? &item.mesh : item.scene_model->get_meshes().data();
+        size_t num_meshes = item.mesh ? 1 : item.scene_model->get_meshes().size();
+
+        // Meshes without a position stream stay with DrawList
+        for (size_t m = 0; m < num_meshes; ++m)
+        {
+            const auto& mesh = meshes[m];
+
+            if (!mesh->has_position_stream())
+            {
+                continue;
+            }
+
+            BoundingBox bounds = mesh->get_bounds().transform(item.model);
+            const GeometryPool::Range& range = mesh->get_position_range();
+
+            objects.push_back(Object{glm::vec4{bounds.get_min(), 1.f}, glm::vec4{bounds.get_max(), 1.f},
+                                     range.index_count, range.first_index, range.base_vertex, GLuint(i)});
+        }
+    }
+
+    if (objects.empty())
+    {
+        return;
+    }
+
+    // Respecifying the store orphans the one last frame's cull may still be reading
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, objects_buffer_id);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, objects.size() * sizeof(Object), objects.data(), GL_STREAM_DRAW);
+
+    if (objects.size() > command_capacity)
+    {
+        command_capacity = std::max<size_t>(2 * objects.size(), 256);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, commands_buffer_id);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, command_capacity * sizeof(DrawList::DrawCommand), nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuCulling::cull(const Frustum& frustum, const DepthPyramid& pyramid, const glm::mat4& pyramid_view_projection, GLuint pyramid_texture_unit) noexcept
+{
+    if (objects.empty())
+    {
+        return;
+    }
+
+    GLuint zero = 0;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, draw_count_buffer_id);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+    if (!indirect_count)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, commands_buffer_id);
+        glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, objects.size() * sizeof(DrawList::DrawCommand), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    cull_shader->use();
+    cull_shader->set_culling(objects.size(), frustum.get_planes());
+
+    bool occlusion = pyramid.is_built();
+
+    if (occlusion)
+    {
+        pyramid.read(GL_TEXTURE0 + pyramid_texture_unit);
+    }
+
+    cull_shader->set_occlusion_culling(occlusion, pyramid_texture_unit, pyramid_view_projection, pyramid.get_depth_size(), pyramid.get_num_levels());
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECTS_BINDING, objects_buffer_id);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMANDS_BINDING, commands_buffer_id);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_COUNT_BINDING, draw_count_buffer_id);
+
+    glDispatchCompute((objects.size() + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1, 1);
+
+    // The draws take their commands and count from what the shader wrote, and next frame's clears overwrite them
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECTS_BINDING, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMANDS_BINDING, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_COUNT_BINDING, 0);
+}
+
+void GpuCulling::draw() const noexcept
+{
+    if (objects.empty())
+    {
+        return;
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands_buffer_id);
+    pool->bind_indirect();
+
+    if (indirect_count)
+    {
+        glBindBuffer(GL_PARAMETER_BUFFER, draw_count_buffer_id);
+
+        if (GLEW_VERSION_4_6)
+        {
+            glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, GLsizei(objects.size()), 0);
+        }
+        else
+        {
+            glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, GLsizei(objects.size()), 0);
+        }
+
+        glBindBuffer(GL_PARAMETER_BUFFER, 0);
+    }
+    else
+    {
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, GLsizei(objects.size()), 0);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
\ No newline at end of file
@@ -1,10 +1,9 @@
 #include <Light.hpp>
 
-Light::Light(GLuint shadow_width, GLuint shadow_height, GLfloat red, GLfloat green, GLfloat blue, GLfloat _ambient_intensity, GLfloat _diffuse_intensity) noexcept
+Light::Light(GLfloat red, GLfloat green, GLfloat blue, GLfloat _ambient_intensity, GLfloat _diffuse_intensity) noexcept
     : color{red, green, blue}, ambient_intensity{_ambient_intensity}, diffuse_intensity{_diffuse_intensity}
 {
-    shadow_map = std::make_shared<ShadowMap>();
-    shadow_map->init(shadow_width, shadow_height);
+
 }
 
 Light::~Light()
@@ -12,6 +11,23 @@ Light::~Light()
 
 }
 
+void Light::invalidate_shadow_map(const std::vector<BoundingBox>& changed_bounds) noexcept
+{
+    if (!shadow_map || shadow_map->is_dirty())
+    {
+        return;
+    }
+
+    for (const auto& bounds: changed_bounds)
+    {
+        if (shadow_volume_intersects(bounds))
+        {
+            shadow_map->mark_dirty();
+            return;
+        }
+    }
+}
+
 void Light::use(GLuint color_id,GLuint ambient_intensity_id, GLuint diffuse_intensity_id) const noexcept
 {
     glUniform3f(color_id, color.x, color.y, color.z);
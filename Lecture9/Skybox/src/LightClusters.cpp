@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <cmath>
+
+#if defined(SKYBOX_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <LightClusters.hpp>
+
+LightClusters::LightClusters() noexcept : workers{WorkerPool::get_instance()}
+{
+
+}
+
+LightClusters::~LightClusters()
+{
+    for (auto buffer: {&lights_buffer, &table_buffer, &indices_buffer})
+    {
+        glDeleteTextures(1, &buffer->texture_id);
+        glDeleteBuffers(1, &buffer->buffer_id);
+    }
+}
+
+bool LightClusters::init() noexcept
+{
+    slices.resize(CLUSTERS_Z);
+
+    return create_buffer(lights_buffer, GL_RGBA32F) && create_buffer(table_buffer, GL_RG32UI) && create_buffer(indices_buffer, GL_R32UI);
+}
+
+bool LightClusters::create_buffer(TextureBuffer& buffer, GLenum internal_format) noexcept
+{
+    glGenBuffers(1, &buffer.buffer_id);
+    glGenTextures(1, &buffer.texture_id);
+
+    // A texture buffer cannot be empty, start with a small store
+    upload(buffer, internal_format, nullptr, 0);
+
+    if (buffer.buffer_id == 0 || buffer.texture_id == 0)
+    {
+        LOG_INIT_CERR();
+        log(LOG_ERR) << "Could not create the light cluster buffers\n";
+        return false;
+    }
+
+    return true;
+}
+
+void LightClusters::upload(TextureBuffer& buffer, GLenum internal_format, const void* data, size_t size) noexcept
+{
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer.buffer_id);
+
+    if (size > buffer.capacity || buffer.capacity == 0)
+    {
+        buffer.capacity = std::max<size_t>(2 * size, 1024);
+        glBufferData(GL_TEXTURE_BUFFER, buffer.capacity, nullptr, GL_STREAM_DRAW);
+
+        glBindTexture(GL_TEXTURE_BUFFER, buffer.texture_id);
+        glTexBuffer(GL_TEXTURE_BUFFER, internal_format, buffer.buffer_id);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+    else
+    {
+        // Orphans last frame's contents instead of waiting for the draws still reading them
+        glBufferData(GL_TEXTURE_BUFFER, buffer.capacity, nullptr, GL_STREAM_DRAW);
+    }
+
+    if (size > 0)
+    {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void LightClusters::set_projection(GLfloat fov, GLfloat aspect, GLfloat near, GLfloat far) noexcept
+{
+    near_plane = near;
+    far_plane = far;
+
+    cluster_min.resize(NUM_CLUSTERS);
+    cluster_max.resize(NUM_CLUSTERS);
+
+    GLfloat tan_y = std::tan(fov / 2.f);
+    GLfloat tan_x = tan_y * aspect;
+
+    for (GLuint z = 0; z < CLUSTERS_Z; ++z)
+    {
+        // Exponential slices keep the clusters roughly cubic along the view
+        GLfloat depth_near = near * std::pow(far / near, GLfloat(z) / CLUSTERS_Z);
+        GLfloat depth_far = near * std::pow(far / near, GLfloat(z + 1) / CLUSTERS_Z);
+
+        for (GLuint y = 0; y < CLUSTERS_Y; ++y)
+        {
+            GLfloat y_0 = -1.f + 2.f * y / CLUSTERS_Y;
+            GLfloat y_1 = -1.f + 2.f * (y + 1) / CLUSTERS_Y;
+
+            for (GLuint x = 0; x < CLUSTERS_X; ++x)
+            {
+                GLfloat x_0 = -1.f + 2.f * x / CLUSTERS_X;
+                GLfloat x_1 = -1.f + 2.f * (x + 1) / CLUSTERS_X;
+
+                // The tile's side planes go through the eye, so its extremes are at either depth
+                size_t cluster = (z * CLUSTERS_Y + y) * CLUSTERS_X + x;
+                cluster_min[cluster] = glm::vec3{
+                    std::min({x_0 * tan_x * depth_near, x_0 * tan_x * depth_far}),
+                    std::min({y_0 * tan_y * depth_near, y_0 * tan_y * depth_far}),
+                    -depth_far
+                };
+                cluster_max[cluster] = glm::vec3{
+                    std::max({x_1 * tan_x * depth_near, x_1 * tan_x * depth_far}),
+                    std::max({y_1 * tan_y * depth_near, y_1 * tan_y * depth_far}),
+                    -depth_near
+                };
+            }
+        }
+    }
+}
+
+glm::vec2 LightClusters::get_depth_slicing() const noexcept
+{
+    GLfloat scale = CLUSTERS_Z / std::log(far_plane / near_plane);
+
+    return glm::vec2{scale, -std::log(near_plane) * scale};
+}
+
+void LightClusters::update(const glm::mat4& view, const LightTable& lights) noexcept
+{
+    num_point_lights = lights.get_num_point_lights();
+    size_t num_lights = lights.get_num_lights();
+
+    // Only the move to view space is left per frame, the spheres themselves come precomputed
+    const std::vector<glm::vec4>& world_spheres = lights.get_bounding_spheres();
+    spheres.resize(num_lights);
+
+    for (size_t i = 0; i < num_lights; ++i)
+    {
+        spheres[i] = glm::vec4{glm::vec3{view * glm::vec4{glm::vec3{world_spheres[i]}, 1.f}}, world_spheres[i].w};
+    }
+
+    // Every slice is binned independently, one task each
+    if (num_lights >= PARALLEL_THRESHOLD)
+    {
+        workers->run(CLUSTERS_Z, [this](size_t z) { bin_slice(z); });
+    }
+    else
+    {
+        for (GLuint z = 0; z < CLUSTERS_Z; ++z)
+        {
+            bin_slice(z);
+        }
+    }
+
+    cluster_table.resize(2 * NUM_CLUSTERS);
+    light_indices.clear();
+
+    for (GLuint z = 0; z < CLUSTERS_Z; ++z)
+    {
+        const Slice& slice = slices[z];
+        GLuint offset = light_indices.size();
+
+        for (size_t tile = 0; tile < CLUSTERS_X * CLUSTERS_Y; ++tile)
+        {
+            size_t cluster = z * CLUSTERS_X * CLUSTERS_Y + tile;
+            cluster_table[2 * cluster] = offset;
+            cluster_table[2 * cluster + 1] = slice.counts[tile];
+            offset += slice.counts[tile];
+        }
+
+        light_indices.insert(light_indices.end(), slice.indices.begin(), slice.indices.end());
+    }
+
+    // The packed lights only change with the table
+    if (lights.get_num_updated() > 0)
+    {
+        upload(lights_buffer, GL_RGBA32F, lights.get_texels().data(), lights.get_texels().size() * sizeof(glm::vec4));
+    }
+
+    upload(table_buffer, GL_RG32UI, cluster_table.data(), cluster_table.size() * sizeof(GLuint));
+    upload(indices_buffer, GL_R32UI, light_indices.data(), light_indices.size() * sizeof(GLuint));
+}
+
+void LightClusters::bin_slice(GLuint slice_index) noexcept
+{
+    Slice& slice = slices[slice_index];
+    size_t first_cluster = slice_index * CLUSTERS_X * CLUSTERS_Y;
+    GLfloat slice_near = -cluster_max[first_cluster].z;
+    GLfloat slice_far = -cluster_min[first_cluster].z;
+
+    slice.x.clear();
+    slice.y.clear();
+    slice.z.clear();
+    slice.radius_squared.clear();
+    slice.ids.clear();
+
+    // Only the lights reaching this slice's depth range are tested against its tiles
+    for (size_t i = 0; i < spheres.size(); ++i)
+    {
+        const glm::vec4& sphere = spheres[i];
+        GLfloat depth = -sphere.z;
+
+        if (depth + sphere.w < slice_near || depth - sphere.w > slice_far)
+        {
+            continue;
+        }
+
+        slice.x.push_back(sphere.x);
+        slice.y.push_back(sphere.y);
+        slice.z.push_back(sphere.z);
+        slice.radius_squared.push_back(sphere.w * sphere.w);
+        slice.ids.push_back(i);
+    }
+
+    // A negative squared radius never passes the test
+    while (slice.ids.size() % 4 != 0)
+    {
+        slice.x.push_back(0.f);
+        slice.y.push_back(0.f);
+        slice.z.push_back(0.f);
+        slice.radius_squared.push_back(-1.f);
+        slice.ids.push_back(0);
+    }
+
+    slice.counts.assign(CLUSTERS_X * CLUSTERS_Y, 0);
+    slice.indices.clear();
+
+    for (size_t tile = 0; tile < CLUSTERS_X * CLUSTERS_Y; ++tile)
+    {
+        const glm::vec3& box_min = cluster_min[first_cluster + tile];
+        const glm::vec3& box_max = cluster_max[first_cluster + tile];
+        size_t first_index = slice.indices.size();
+
+#if defined(SKYBOX_SIMD) && defined(__SSE2__)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 min_x = _mm_set1_ps(box_min.x), min_y = _mm_set1_ps(box_min.y), min_z = _mm_set1_ps(box_min.z);
+        const __m128 max_x = _mm_set1_ps(box_max.x), max_y = _mm_set1_ps(box_max.y), max_z = _mm_set1_ps(box_max.z);
+
+        for (size_t i = 0; i < slice.ids.size(); i += 4)
+        {
+            // Squared distance from each center to the box, zero inside it
+            __m128 x = _mm_loadu_ps(&slice.x[i]);
+            __m128 y = _mm_loadu_ps(&slice.y[i]);
+            __m128 z = _mm_loadu_ps(&slice.z[i]);
+            __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min_x, x), _mm_sub_ps(x, max_x)), zero);
+            __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min_y, y), _mm_sub_ps(y, max_y)), zero);
+            __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min_z, z), _mm_sub_ps(z, max_z)), zero);
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+            int mask = _mm_movemask_ps(_mm_cmple_ps(distance, _mm_loadu_ps(&slice.radius_squared[i])));
+
+            for (int lane = 0; mask != 0 && lane < 4; ++lane)
+            {
+                if (mask & (1 << lane))
+                {
+                    slice.indices.push_back(slice.ids[i + lane]);
+                }
+            }
+        }
+#else
+        for (size_t i = 0; i < slice.ids.size(); ++i)
+        {
+            GLfloat dx = std::max({box_min.x - slice.x[i], slice.x[i] - box_max.x, 0.f});
+            GLfloat dy = std::max({box_min.y - slice.y[i], slice.y[i] - box_max.y, 0.f});
+            GLfloat dz = std::max({box_min.z - slice.z[i], slice.z[i] - box_max.z, 0.f});
+
+            if (dx * dx + dy * dy + dz * dz <= slice.radius_squared[i])
+            {
+                slice.indices.push_back(slice.ids[i]);
+            }
+        }
+#endif
+
+        slice.counts[tile] = slice.indices.size() - first_index;
+    }
+}
+
+void LightClusters::read(GLenum lights_texture_unit, GLenum table_texture_unit, GLenum indices_texture_unit) const noexcept
+{
+    glActiveTexture(lights_texture_unit);
+    glBindTexture(GL_TEXTURE_BUFFER, lights_buffer.texture_id);
+    glActiveTexture(table_texture_unit);
+    glBindTexture(GL_TEXTURE_BUFFER, table_buffer.texture_id);
+    glActiveTexture(indices_texture_unit);
+    glBindTexture(GL_TEXTURE_BUFFER, indices_buffer.texture_id);
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include <LightTable.hpp>
+
+void LightTable::update(const std::vector<std::shared_ptr<PointLight>>& point_lights,
+                        const std::vector<std::shared_ptr<SpotLight>>& spot_lights,
+                        size_t max_shadowed_point_lights, size_t max_shadowed_spot_lights) noexcept
+{
+    size_t num_lights = point_lights.size() + spot_lights.size();
+    bool resized = num_lights != sources.size() || point_lights.size() != num_point_lights;
+
+    if (resized)
+    {
+        // A light that moves to another slot no longer matches its old entry and is recomputed
+        sources.resize(num_lights, nullptr);
+        versions.resize(num_lights, 0);
+        shadow_indices.resize(num_lights, -1);
+        ranges.resize(num_lights);
+        spheres.resize(num_lights);
+        directions.resize(num_lights);
+        cos_edges.resize(num_lights);
+        texels.resize(num_lights * TEXELS_PER_LIGHT);
+        point_transforms.resize(point_lights.size());
+        spot_transforms.resize(spot_lights.size());
+        num_point_lights = point_lights.size();
+    }
+
+    num_updated = 0;
+    bool moved = resized;
+
+    for (size_t i = 0; i < point_lights.size(); ++i)
+    {
+        const PointLight& light = *point_lights[i];
+        moved = moved || sources[i] != &light;
+
+        // A new shadow slot only changes the packed texels, not the geometry
+        bool changed = sources[i] != &light || versions[i] != light.get_version();
+
+        if (update_entry(i, light, i < max_shadowed_point_lights ? GLint(i) : -1) && changed)
+        {
+            point_transforms[i] = light.get_light_transforms();
+        }
+    }
+
+    for (size_t i = 0; i < spot_lights.size(); ++i)
+    {
+        const SpotLight& light = *spot_lights[i];
+        size_t index = get_spot_light_index(i);
+        moved = moved || sources[index] != &light;
+
+        bool changed = sources[index] != &light || versions[index] != light.get_version();
+
+        if (update_entry(index, light, i < max_shadowed_spot_lights ? GLint(i) : -1) && changed)
+        {
+            spot_transforms[i] = light.get_light_transform();
+        }
+    }
+
+    if (moved)
+    {
+        indices.clear();
+
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            indices[sources[i]] = i;
+        }
+    }
+}
+
+bool LightTable::update_entry(size_t index, const PointLight& light, GLint shadow_index) noexcept
+{
+    if (sources[index] == &light && versions[index] == light.get_version() && shadow_indices[index] == shadow_index)
+    {
+        return false;
+    }
+
+    sources[index] = &light;
+    versions[index] = light.get_version();
+    shadow_indices[index] = shadow_index;
+
+    ranges[index] = light.get_range();
+    spheres[index] = light.get_bounding_sphere();
+
+    // Point lights have no cone, a cosine of -1 lets every direction through
+    auto spot_light = index >= num_point_lights ? static_cast<const SpotLight*>(&light) : nullptr;
+    directions[index] = spot_light ? spot_light->get_direction() : glm::vec3{0.f};
+    cos_edges[index] = spot_light ? spot_light->get_cos_edge() : -1.f;
+
+    glm::vec4* entry = &texels[index * TEXELS_PER_LIGHT];
+    entry[0] = glm::vec4{light.get_color(), light.get_ambient_intensity()};
+    entry[1] = glm::vec4{light.get_position(), light.get_diffuse_intensity()};
+    entry[2] = glm::vec4{light.get_attenuation(), GLfloat(shadow_index)};
+    entry[3] = glm::vec4{directions[index], cos_edges[index]};
+
+    ++num_updated;
+
+    return true;
+}
+
+GLint LightTable::find(const PointLight* light) const noexcept
+{
+    auto it = indices.find(light);
+
+    return it == indices.end() ? -1 : GLint(it->second);
+}
\ No newline at end of file
@@ -1,11 +1,21 @@
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <map>
+
 #include <Mesh.hpp>
 
-std::shared_ptr<Mesh> Mesh::create(const std::vector<GLfloat>& vertices, std::vector<unsigned int>& indices) noexcept
+std::shared_ptr<Mesh> Mesh::create(const std::vector<GLfloat>& vertices, std::vector<unsigned int>& indices, bool position_stream) noexcept
 {
     auto mesh = std::make_shared<Mesh>();
 
     mesh->index_count = indices.size();
 
+    for (size_t i = 0; i + 2 < vertices.size(); i += VERTEX_LENGTH)
+    {
+        mesh->bounds.expand(glm::vec3{vertices[i], vertices[i + 1], vertices[i + 2]});
+    }
+
     glGenVertexArrays(1, &mesh->VAO_id);
     glBindVertexArray(mesh->VAO_id);
 
@@ -17,11 +27,11 @@ std::shared_ptr<Mesh> Mesh::create(const std::vector<GLfloat>& vertices, std::ve
     glBindBuffer(GL_ARRAY_BUFFER, mesh->VBO_id);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 8, nullptr);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * VERTEX_LENGTH, nullptr);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 8, reinterpret_cast<void*>(sizeof(GLfloat) * 3));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * VERTEX_LENGTH, reinterpret_cast<void*>(sizeof(GLfloat) * 3));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 8, reinterpret_cast<void*>(sizeof(GLfloat) * 5));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * VERTEX_LENGTH, reinterpret_cast<void*>(sizeof(GLfloat) * 5));
     glEnableVertexAttribArray(2);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -29,25 +39,132 @@ std::shared_ptr<Mesh> Mesh::create(const std::vector<GLfloat>& vertices, std::ve
 
     glBindVertexArray(0);
 
+    if (position_stream)
+    {
+        mesh->create_position_stream(vertices, indices);
+    }
+
     return mesh;
 }
 
+void Mesh::create_position_stream(const std::vector<GLfloat>& vertices, const std::vector<unsigned int>& indices) noexcept
+{
+    // Vertices split only by their UV or normal share one position here
+    std::map<std::array<GLfloat, 3>, unsigned int> welded;
+    std::vector<unsigned int> remap(vertices.size() / VERTEX_LENGTH);
+    std::vector<GLfloat> positions;
+
+    for (size_t v = 0; v < remap.size(); ++v)
+    {
+        const GLfloat* vertex = &vertices[v * VERTEX_LENGTH];
+        auto [it, inserted] = welded.try_emplace({vertex[0], vertex[1], vertex[2]}, unsigned(positions.size() / 3));
+
+        if (inserted)
+        {
+            positions.insert(positions.end(), {vertex[0], vertex[1], vertex[2]});
+        }
+
+        remap[v] = it->second;
+    }
+
+    std::vector<unsigned int> position_indices;
+    position_indices.reserve(indices.size());
+
+    for (auto index: indices)
+    {
+        position_indices.push_back(remap[index]);
+    }
+
+    position_pool = GeometryPool::get_instance();
+    position_range = position_pool->add(positions, position_indices);
+
+    create_occluder(positions, position_indices);
+}
+
+void Mesh::create_occluder(const std::vector<GLfloat>& positions, const std::vector<unsigned int>& indices) noexcept
+{
+    auto position = [&positions](unsigned int index) {
+        return glm::vec3{positions[3 * index], positions[3 * index + 1], positions[3 * index + 2]};
+    };
+
+    // Twice the area of every non-degenerate triangle, with its first index
+    std::vector<std::pair<GLfloat, size_t>> areas;
+    areas.reserve(indices.size() / 3);
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        glm::vec3 a = position(indices[i]);
+        GLfloat area = glm::length(glm::cross(position(indices[i + 1]) - a, position(indices[i + 2]) - a));
+
+        if (area > 0.f)
+        {
+            areas.emplace_back(area, i);
+        }
+    }
+
+    if (areas.size() > MAX_OCCLUDER_TRIANGLES)
+    {
+        std::nth_element(areas.begin(), areas.begin() + MAX_OCCLUDER_TRIANGLES, areas.end(), std::greater<>{});
+        areas.resize(MAX_OCCLUDER_TRIANGLES);
+    }
+
+    occluder_triangles.clear();
+    occluder_triangles.reserve(3 * areas.size());
+
+    for (const auto& [area, first]: areas)
+    {
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            occluder_triangles.push_back(position(indices[first + corner]));
+        }
+    }
+}
+
 Mesh::~Mesh()
 {
     clear();
 }
 
-void Mesh::render() const noexcept
+void Mesh::render(GLsizei instance_count) const noexcept
 {
     glBindVertexArray(VAO_id);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO_id);
-    glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, NULL);
+
+    if (instance_count == 1)
+    {
+        glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, NULL);
+    }
+    else
+    {
+        glDrawElementsInstanced(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, NULL, instance_count);
+    }
+
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 }
 
+void Mesh::render_positions(GLsizei instance_count) const noexcept
+{
+    if (!position_pool)
+    {
+        render(instance_count);
+        return;
+    }
+
+    // The pool's VAO keeps its index buffer bound
+    position_pool->bind();
+
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, position_range.index_count, GL_UNSIGNED_INT,
+                                      reinterpret_cast<void*>(position_range.first_index * sizeof(unsigned int)),
+                                      instance_count, position_range.base_vertex);
+
+    glBindVertexArray(0);
+}
+
 void Mesh::clear() noexcept
 {
+    position_pool = nullptr;
+
     if (IBO_id != 0)
     {
         glDeleteBuffers(1, &IBO_id);
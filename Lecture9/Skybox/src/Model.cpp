@@ -24,7 +24,7 @@ void Model::load(std::string_view model_name) noexcept
     load_textures(scene);
 }
 
-void Model::render() const noexcept
+void Model::render(GLsizei instance_count) const noexcept
 {
     for (size_t i = 0; i < mesh_list.size(); ++i)
     {
@@ -35,10 +35,30 @@ void Model::render() const noexcept
             texture_list[t_i]->use();
         }
 
-        mesh_list[i]->render();
+        mesh_list[i]->render(instance_count);
     }
 }
 
+void Model::render_positions(GLsizei instance_count) const noexcept
+{
+    for (const auto& mesh: mesh_list)
+    {
+        mesh->render_positions(instance_count);
+    }
+}
+
+BoundingBox Model::get_bounds() const noexcept
+{
+    BoundingBox bounds{};
+
+    for (const auto& mesh: mesh_list)
+    {
+        bounds.expand(mesh->get_bounds());
+    }
+
+    return bounds;
+}
+
 void Model::load_node(aiNode* node, const aiScene* scene) noexcept
 {
     for (size_t i = 0; i < node->mNumMeshes; ++i)
@@ -83,7 +103,7 @@ void Model::load_mesh(aiMesh* mesh) noexcept
         }
     }
 
-    mesh_list.push_back(Mesh::create(vertices, indices));
+    mesh_list.push_back(Mesh::create(vertices, indices, true));
     mesh_to_texture.push_back(mesh->mMaterialIndex);
 }
 
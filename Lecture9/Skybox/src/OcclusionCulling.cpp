@@ -0,0 +1,242 @@
+#include <OcclusionCulling.hpp>
+
+OcclusionCulling::OcclusionCulling(std::shared_ptr<Shader> _box_shader, GLfloat _near_margin) noexcept
+    : box_shader{_box_shader}, near_margin{_near_margin}
+{
+
+}
+
+OcclusionCulling::~OcclusionCulling()
+{
+    resize(0);
+    glDeleteVertexArrays(1, &box_VAO_id);
+}
+
+bool OcclusionCulling::init() noexcept
+{
+    // The box is built from gl_VertexID, but a core context still needs a VAO
+    glGenVertexArrays(1, &box_VAO_id);
+
+    if (box_VAO_id == 0)
+    {
+        LOG_INIT_CERR();
+        log(LOG_ERR) << "Could not create the occlusion box vertex array\n";
+        return false;
+    }
+
+    // The conservative target may answer before rasterizing every sample, it only errs towards visible
+    if (GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility)
+    {
+        query_target = GL_ANY_SAMPLES_PASSED_CONSERVATIVE;
+    }
+
+    LOG_INIT_COUT();
+    log(LOG_INFO) << "Occlusion queries: " << (query_target == GL_ANY_SAMPLES_PASSED ? "GL_ANY_SAMPLES_PASSED" : "GL_ANY_SAMPLES_PASSED_CONSERVATIVE") << "\n";
+
+    return true;
+}
+
+void OcclusionCulling::resize(size_t num_objects) noexcept
+{
+    for (auto& object: objects)
+    {
+        glDeleteQueries(NUM_BUFFERED_FRAMES, object.queries.data());
+    }
+
+    objects.assign(num_objects, Object{});
+
+    for (auto& object: objects)
+    {
+        glGenQueries(NUM_BUFFERED_FRAMES, object.queries.data());
+    }
+}
+
+void OcclusionCulling::read_result(Object& object, size_t result_slot, bool wait) noexcept
+{
+    if (!object.pending[result_slot])
+    {
+        return;
+    }
+
+    GLuint query = object.queries[result_slot];
+
+    if (!wait)
+    {
+        GLuint available = 0;
+        glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (!available)
+        {
+            return;
+        }
+    }
+
+    GLuint any_samples = 0;
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT, &any_samples);
+
+    object.visible = any_samples != 0;
+    object.pending[result_slot] = false;
+}
+
+void OcclusionCulling::begin_frame(const DrawList& draw_list) noexcept
+{
+    // Items are matched by index, a different list starts over with everything visible
+    if (draw_list.get_items().size() != objects.size())
+    {
+        resize(draw_list.get_items().size());
+    }
+
+    slot = (slot + 1) % NUM_BUFFERED_FRAMES;
+
+    for (auto& object: objects)
+    {
+        // Oldest first, so the newest available answer wins. This frame's
+        // slot is about to be reused; after NUM_BUFFERED_FRAMES frames its
+        // result is there, the wait is only a safeguard.
+        read_result(object, slot, true);
+
+        for (size_t i = 1; i < NUM_BUFFERED_FRAMES; ++i)
+        {
+            read_result(object, (slot + i) % NUM_BUFFERED_FRAMES, false);
+        }
+
+        object.queried = false;
+    }
+}
+
+void OcclusionCulling::render(std::string_view pass, DrawList& draw_list, DrawList::Mode mode, const DrawFilter& filter,
+                              const Shader& pass_shader, const glm::mat4& projection, const glm::mat4& view, const glm::vec3& eye) noexcept
+{
+    auto cpu_start = std::chrono::steady_clock::now();
+
+    size_t draw_calls = 0;
+    size_t num_commands = 0;
+
+    const auto& items = draw_list.get_items();
+    hidden.clear();
+
+    // Last frame's visible items first, they make up most of the depth the boxes are tested against
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        if (filter && filter(items[i].bounds, i) <= 0)
+        {
+            continue;
+        }
+
+        Object& object = objects[i];
+        const BoundingBox& bounds = items[i].bounds;
+
+        if (!object.visible && !bounds.intersects_sphere(eye, near_margin))
+        {
+            hidden.push_back(i);
+            continue;
+        }
+
+        glBeginQuery(query_target, object.queries[slot]);
+        size_t meshes = draw_list.draw_item(i, mode);
+        glEndQuery(query_target);
+
+        object.pending[slot] = true;
+        object.queried = true;
+        draw_calls += meshes;
+        num_commands += meshes;
+    }
+
+    num_tested += hidden.size();
+
+    if (!hidden.empty())
+    {
+        GLboolean color_mask[4];
+        GLboolean depth_mask;
+        glGetBooleanv(GL_COLOR_WRITEMASK, color_mask);
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_mask);
+
+        box_shader->use();
+        glUniformMatrix4fv(box_shader->get_uniform_projection_id(), 1, GL_FALSE, glm::value_ptr(projection));
+        glUniformMatrix4fv(box_shader->get_uniform_view_id(), 1, GL_FALSE, glm::value_ptr(view));
+
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        glBindVertexArray(box_VAO_id);
+
+        for (size_t i: hidden)
+        {
+            Object& object = objects[i];
+            box_shader->set_bounds(items[i].bounds.get_min(), items[i].bounds.get_max());
+
+            glBeginQuery(query_target, object.queries[slot]);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            glEndQuery(query_target);
+
+            object.pending[slot] = true;
+            object.queried = true;
+        }
+
+        glBindVertexArray(0);
+        glColorMask(color_mask[0], color_mask[1], color_mask[2], color_mask[3]);
+        glDepthMask(depth_mask);
+
+        draw_calls += hidden.size();
+
+        // Drawn only if the box showed, decided on the GPU
+        pass_shader.use();
+
+        for (size_t i: hidden)
+        {
+            glBeginConditionalRender(objects[i].queries[slot], GL_QUERY_WAIT);
+            size_t meshes = draw_list.draw_item(i, mode);
+            glEndConditionalRender();
+
+            draw_calls += meshes;
+            num_commands += meshes;
+        }
+    }
+
+    draw_list.add_stats(pass, draw_calls, num_commands, cpu_start);
+}
+
+void OcclusionCulling::render_conditional(std::string_view pass, DrawList& draw_list, DrawList::Mode mode) noexcept
+{
+    auto cpu_start = std::chrono::steady_clock::now();
+
+    size_t draw_calls = 0;
+
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        // Not queried means outside the frustum
+        if (!objects[i].queried)
+        {
+            continue;
+        }
+
+        glBeginConditionalRender(objects[i].queries[slot], GL_QUERY_WAIT);
+        draw_calls += draw_list.draw_item(i, mode);
+        glEndConditionalRender();
+    }
+
+    draw_list.add_stats(pass, draw_calls, draw_calls, cpu_start);
+}
+
+void OcclusionCulling::end_frame() noexcept
+{
+    for (const auto& object: objects)
+    {
+        if (object.queried && !object.visible)
+        {
+            ++num_hidden;
+        }
+    }
+
+    if (++num_frames < REPORT_INTERVAL)
+    {
+        return;
+    }
+
+    LOG_INIT_COUT();
+    log(LOG_INFO) << "Occlusion queries: " << double(num_tested) / num_frames << " box tests and "
+                  << double(num_hidden) / num_frames << " items known hidden per frame\n";
+
+    num_frames = 0;
+    num_tested = 0;
+    num_hidden = 0;
+}
\ No newline at end of file
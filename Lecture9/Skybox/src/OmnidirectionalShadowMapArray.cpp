@@ -0,0 +1,179 @@
+#include <OmnidirectionalShadowMapArray.hpp>
+#include <OmnidirectionalShadowMap.hpp>
+
+std::weak_ptr<OmnidirectionalShadowMapArray> OmnidirectionalShadowMapArray::instance{};
+
+std::shared_ptr<OmnidirectionalShadowMapArray> OmnidirectionalShadowMapArray::get_instance(GLuint w, GLuint h) noexcept
+{
+    auto storage = instance.lock();
+
+    if (!storage)
+    {
+        storage = std::make_shared<OmnidirectionalShadowMapArray>(w, h);
+        instance = storage;
+    }
+    else if (storage->width != w || storage->height != h)
+    {
+        LOG_INIT_CERR();
+        log(LOG_WARN) << "Omnidirectional shadow maps share one resolution, using " << storage->width << "x" << storage->height << "\n";
+    }
+
+    return storage;
+}
+
+OmnidirectionalShadowMapArray::OmnidirectionalShadowMapArray(GLuint w, GLuint h) noexcept
+    : width{w}, height{h}
+{
+    glGenFramebuffers(1, &FBO_id);
+    glGenFramebuffers(1, &face_FBO_id);
+}
+
+OmnidirectionalShadowMapArray::~OmnidirectionalShadowMapArray()
+{
+    glDeleteFramebuffers(1, &FBO_id);
+    glDeleteFramebuffers(1, &face_FBO_id);
+    glDeleteTextures(1, &shadow_map_id);
+
+    if (moments_id)
+    {
+        glDeleteTextures(1, &moments_id);
+    }
+}
+
+GLint OmnidirectionalShadowMapArray::allocate(OmnidirectionalShadowMap* shadow_map) noexcept
+{
+    auto it = std::find(cubes.begin(), cubes.end(), nullptr);
+
+    if (it == cubes.end())
+    {
+        if (!resize(std::max(INITIAL_CAPACITY, 2 * cubes.size())))
+        {
+            return -1;
+        }
+
+        it = std::find(cubes.begin(), cubes.end(), nullptr);
+    }
+
+    *it = shadow_map;
+
+    return GLint(it - cubes.begin());
+}
+
+void OmnidirectionalShadowMapArray::release(GLint cube) noexcept
+{
+    if (cube >= 0 && size_t(cube) < cubes.size())
+    {
+        cubes[cube] = nullptr;
+    }
+}
+
+bool OmnidirectionalShadowMapArray::resize(size_t capacity) noexcept
+{
+    GLint max_layers{0};
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+
+    if (capacity * NUM_FACES > size_t(max_layers))
+    {
+        LOG_INIT_CERR();
+        log(LOG_ERR) << "Cube map array cannot hold " << capacity << " shadow cubes\n";
+        return false;
+    }
+
+    // The previous contents are not copied, every cube is rendered again
+    glDeleteTextures(1, &shadow_map_id);
+    glGenTextures(1, &shadow_map_id);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, shadow_map_id);
+    glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_DEPTH_COMPONENT, width, height, capacity * NUM_FACES, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO_id);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadow_map_id, 0);
+
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG_INIT_CERR();
+        log(LOG_ERR) << "Framebuffer error: " << status << "\n";
+        return false;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, face_FBO_id);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    cubes.resize(capacity, nullptr);
+
+    if (moments_id)
+    {
+        create_moments();
+    }
+
+    for (auto shadow_map: cubes)
+    {
+        if (shadow_map)
+        {
+            shadow_map->mark_dirty();
+        }
+    }
+
+    return true;
+}
+
+void OmnidirectionalShadowMapArray::write() const noexcept
+{
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, FBO_id);
+}
+
+void OmnidirectionalShadowMapArray::write_face(GLint cube, size_t face) const noexcept
+{
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, face_FBO_id);
+    glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadow_map_id, 0, cube * NUM_FACES + face);
+}
+
+void OmnidirectionalShadowMapArray::read(GLenum texture_unit) const noexcept
+{
+    glActiveTexture(texture_unit);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, shadow_map_id);
+}
+
+bool OmnidirectionalShadowMapArray::init_moments() noexcept
+{
+    if (!moments_id)
+    {
+        create_moments();
+    }
+
+    return moments_id != 0;
+}
+
+void OmnidirectionalShadowMapArray::create_moments() noexcept
+{
+    glDeleteTextures(1, &moments_id);
+    glGenTextures(1, &moments_id);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, moments_id);
+    glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_R32F, width, height, cubes.size() * NUM_FACES, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Allocates the whole mip chain
+    glGenerateMipmap(GL_TEXTURE_CUBE_MAP_ARRAY);
+}
+
+void OmnidirectionalShadowMapArray::read_moments(GLenum texture_unit) const noexcept
+{
+    glActiveTexture(texture_unit);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, moments_id);
+}
\ No newline at end of file
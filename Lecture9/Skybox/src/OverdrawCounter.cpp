@@ -0,0 +1,73 @@
+#include <OverdrawCounter.hpp>
+
+OverdrawCounter::OverdrawCounter(std::string_view _name) noexcept
+    : name{_name}
+{
+    glGenQueries(query_ids.size(), query_ids.data());
+}
+
+OverdrawCounter::~OverdrawCounter()
+{
+    glDeleteQueries(query_ids.size(), query_ids.data());
+}
+
+void OverdrawCounter::begin() noexcept
+{
+    collect(current_frame);
+
+    glBeginQuery(GL_SAMPLES_PASSED, query_ids[current_frame]);
+}
+
+void OverdrawCounter::end(GLuint width, GLuint height) noexcept
+{
+    glEndQuery(GL_SAMPLES_PASSED);
+
+    num_pixels[current_frame] = width * height;
+    pending[current_frame] = true;
+
+    current_frame = (current_frame + 1) % NUM_BUFFERED_FRAMES;
+}
+
+void OverdrawCounter::collect(size_t frame) noexcept
+{
+    if (!pending[frame])
+    {
+        return;
+    }
+
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(query_ids[frame], GL_QUERY_RESULT_AVAILABLE, &available);
+    pending[frame] = false;
+
+    if (!available || num_pixels[frame] == 0)
+    {
+        return;
+    }
+
+    GLuint64 samples = 0;
+    glGetQueryObjectui64v(query_ids[frame], GL_QUERY_RESULT, &samples);
+
+    double sample = double(samples) / num_pixels[frame];
+
+    // Light smoothing keeps a single odd frame from flipping decisions based on it
+    overdraw = has_result ? 0.9 * overdraw + 0.1 * sample : sample;
+    has_result = true;
+
+    total_overdraw += sample;
+    max_overdraw = std::max(max_overdraw, sample);
+
+    if (++num_samples == REPORT_INTERVAL)
+    {
+        report();
+    }
+}
+
+void OverdrawCounter::report() noexcept
+{
+    LOG_INIT_COUT();
+    log(LOG_INFO) << name << ": overdraw " << total_overdraw / num_samples << " average, " << max_overdraw << " peak (" << num_samples << " samples)\n";
+
+    num_samples = 0;
+    total_overdraw = 0.0;
+    max_overdraw = 0.0;
+}
\ No newline at end of file
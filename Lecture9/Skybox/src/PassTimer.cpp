@@ -0,0 +1,83 @@
+#include <PassTimer.hpp>
+
+PassTimer::PassTimer(std::string_view _name) noexcept
+    : name{_name}
+{
+    glGenQueries(query_ids.size(), query_ids.data());
+}
+
+PassTimer::~PassTimer()
+{
+    glDeleteQueries(query_ids.size(), query_ids.data());
+}
+
+void PassTimer::begin() noexcept
+{
+    // The slot about to be reused was written NUM_BUFFERED_FRAMES frames ago
+    collect(current_frame);
+
+    cpu_start = std::chrono::steady_clock::now();
+    glQueryCounter(query_ids[current_frame * 2], GL_TIMESTAMP);
+}
+
+void PassTimer::end() noexcept
+{
+    glQueryCounter(query_ids[current_frame * 2 + 1], GL_TIMESTAMP);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - cpu_start;
+    cpu_ms[current_frame] = elapsed.count();
+    pending[current_frame] = true;
+
+    current_frame = (current_frame + 1) % NUM_BUFFERED_FRAMES;
+}
+
+void PassTimer::reset(std::string_view _name) noexcept
+{
+    name = _name;
+    pending.fill(false);
+    num_samples = 0;
+    total_gpu_ms = 0.0;
+    total_cpu_ms = 0.0;
+}
+
+void PassTimer::collect(size_t frame) noexcept
+{
+    if (!pending[frame])
+    {
+        return;
+    }
+
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(query_ids[frame * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+    if (!available)
+    {
+        // Still in flight after several frames: drop the sample rather than stall
+        pending[frame] = false;
+        return;
+    }
+
+    GLuint64 start_ns = 0;
+    GLuint64 end_ns = 0;
+    glGetQueryObjectui64v(query_ids[frame * 2], GL_QUERY_RESULT, &start_ns);
+    glGetQueryObjectui64v(query_ids[frame * 2 + 1], GL_QUERY_RESULT, &end_ns);
+
+    total_gpu_ms += double(end_ns - start_ns) / 1e6;
+    total_cpu_ms += cpu_ms[frame];
+    pending[frame] = false;
+
+    if (++num_samples == REPORT_INTERVAL)
+    {
+        report();
+    }
+}
+
+void PassTimer::report() noexcept
+{
+    LOG_INIT_COUT();
+    log(LOG_INFO) << name << ": GPU " << total_gpu_ms / num_samples << " ms, CPU " << total_cpu_ms / num_samples << " ms (" << num_samples << " samples)\n";
+
+    num_samples = 0;
+    total_gpu_ms = 0.0;
+    total_cpu_ms = 0.0;
+}
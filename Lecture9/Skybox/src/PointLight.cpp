@@ -1,10 +1,13 @@
+#include <algorithm>
+#include <cmath>
+
 #include <PointLight.hpp>
 
 PointLight::PointLight(GLuint shadow_width, GLuint shadow_height,
                        GLfloat near, GLfloat far,
                        GLfloat red, GLfloat green, GLfloat blue, GLfloat _ambient_intensity, GLfloat _diffuse_intensity,
                        GLfloat pos_x, GLfloat pos_y, GLfloat pos_z, GLfloat _a, GLfloat _b, GLfloat _c) noexcept
-    : Light{shadow_width, shadow_height, red, green, blue, _ambient_intensity, _diffuse_intensity}, far_plane{far}, position{pos_x, pos_y, pos_z}, a{_a}, b{_b}, c{_c}
+    : Light{red, green, blue, _ambient_intensity, _diffuse_intensity}, near_plane{near}, far_plane{far}, position{pos_x, pos_y, pos_z}, a{_a}, b{_b}, c{_c}
 {
     float aspect = float(shadow_width) / float(shadow_height);
     projection = glm::perspective(glm::radians(90.f), aspect, near, far);
@@ -12,6 +15,14 @@ PointLight::PointLight(GLuint shadow_width, GLuint shadow_height,
     shadow_map->init(shadow_width, shadow_height);
 }
 
+PointLight::PointLight(GLfloat near, GLfloat far,
+                       GLfloat red, GLfloat green, GLfloat blue, GLfloat _ambient_intensity, GLfloat _diffuse_intensity,
+                       GLfloat pos_x, GLfloat pos_y, GLfloat pos_z, GLfloat _a, GLfloat _b, GLfloat _c) noexcept
+    : Light{red, green, blue, _ambient_intensity, _diffuse_intensity}, near_plane{near}, far_plane{far}, position{pos_x, pos_y, pos_z}, a{_a}, b{_b}, c{_c}
+{
+
+}
+
 PointLight::~PointLight()
 {
     
@@ -26,9 +37,43 @@ void PointLight::use(GLuint color_id, GLuint ambient_intensity_id, GLuint diffus
     glUniform1f(c_id, c);
 }
 
-std::vector<glm::mat4> PointLight::get_light_transforms() const noexcept
+bool PointLight::shadow_volume_intersects(const BoundingBox& bounds) const noexcept
+{
+    return bounds.intersects_sphere(position, far_plane);
+}
+
+GLfloat PointLight::get_range() const noexcept
+{
+    // Solve a * d^2 + b * d + c = k, where the contribution falls to 1/256
+    GLfloat k = 256.f * diffuse_intensity;
+
+    if (c >= k)
+    {
+        return 0.f;
+    }
+
+    GLfloat range = far_plane;
+
+    if (a > 0.f)
+    {
+        range = (-b + std::sqrt(b * b - 4.f * a * (c - k))) / (2.f * a);
+    }
+    else if (b > 0.f)
+    {
+        range = (k - c) / b;
+    }
+
+    return std::min(range, far_plane);
+}
+
+glm::vec4 PointLight::get_bounding_sphere() const noexcept
+{
+    return glm::vec4{position, get_range()};
+}
+
+std::array<glm::mat4, OmnidirectionalShadowMap::NUM_FACES> PointLight::get_light_transforms() const noexcept
 {
-    return std::vector<glm::mat4>{{
+    return std::array<glm::mat4, OmnidirectionalShadowMap::NUM_FACES>{{
         // +x, -x
         projection * glm::lookAt(position, position + glm::vec3{1.f, 0.f, 0.f}, glm::vec3{0.f, -1.f, 0.f}),
         projection * glm::lookAt(position, position + glm::vec3{-1.f, 0.f, 0.f}, glm::vec3{0.f, -1.f, 0.f}),
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <thread>
+#include <utility>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <Frustum.hpp>
+#include <PotentiallyVisibleSet.hpp>
+
+namespace
+{
+    // The last character is the version of the layout
+    constexpr std::array<char, 4> FILE_MAGIC{'P', 'V', 'S', '2'};
+
+    // Stored as an integer, so reading it back compares exactly
+    constexpr std::uint32_t CELL_SIZE_MILLIMETRES{std::uint32_t(PotentiallyVisibleSet::CELL_SIZE * 1000.f + 0.5f)};
+
+    // Direction and up vector of each face of the cube around a sample
+    const std::array<std::pair<glm::vec3, glm::vec3>, 6> CUBE_FACES{{
+        {glm::vec3{1.f, 0.f, 0.f}, glm::vec3{0.f, -1.f, 0.f}},
+        {glm::vec3{-1.f, 0.f, 0.f}, glm::vec3{0.f, -1.f, 0.f}},
+        {glm::vec3{0.f, 1.f, 0.f}, glm::vec3{0.f, 0.f, 1.f}},
+        {glm::vec3{0.f, -1.f, 0.f}, glm::vec3{0.f, 0.f, -1.f}},
+        {glm::vec3{0.f, 0.f, 1.f}, glm::vec3{0.f, -1.f, 0.f}},
+        {glm::vec3{0.f, 0.f, -1.f}, glm::vec3{0.f, -1.f, 0.f}}
+    }};
+}
+
+bool PotentiallyVisibleSet::bake(const DrawList& draw_list, GLfloat near_plane, GLfloat far_plane) noexcept
+{
+    auto start = std::chrono::steady_clock::now();
+
+    const auto& items = draw_list.get_items();
+    BoundingBox region;
+
+    for (const auto& item: items)
+    {
+        if (item.is_static)
+        {
+            region.expand(item.bounds);
+        }
+    }
+
+    if (region.is_empty())
+    {
+        LOG_INIT_CERR();
+        log(LOG_ERR) << "No static items to bake potentially visible sets for\n";
+        return false;
+    }
+
+    origin = region.get_min() - glm::vec3{MARGIN};
+    glm::vec3 extent = region.get_max() - region.get_min() + glm::vec3{2.f * MARGIN};
+
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        num_cells[axis] = std::max(1u, GLuint(std::ceil(extent[axis] / CELL_SIZE)));
+    }
+
+    size_t total_cells = size_t(num_cells[0]) * num_cells[1] * num_cells[2];
+
+    if (total_cells > MAX_CELLS)
+    {
+        LOG_INIT_CERR();
+        log(LOG_ERR) << "The static items span " << total_cells << " view cells, more than the " << MAX_CELLS << " that can be baked\n";
+        return false;
+    }
+
+    num_items = items.size();
+    words_per_cell = (num_items + 63) / 64;
+    bits.assign(total_cells * words_per_cell, 0);
+    current = nullptr;
+
+    glm::mat4 projection = glm::perspective(glm::radians(90.f), 1.f, near_plane, far_plane);
+
+    // Cells are handed out one at a time, their cost varies with what surrounds them
+    std::atomic<size_t> next_cell{0};
+    size_t num_workers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), total_cells);
+    std::vector<std::thread> workers;
+
+    for (size_t worker = 0; worker < num_workers; ++worker)
+    {
+        workers.emplace_back([this, &draw_list, &next_cell, &projection, total_cells]() {
+            SoftwareOcclusion occlusion{"Visibility baking", SAMPLE_RESOLUTION, SAMPLE_RESOLUTION, false};
+
+            for (size_t cell = next_cell++; cell < total_cells; cell = next_cell++)
+            {
+                bake_cell(draw_list, cell, projection, occlusion);
+            }
+        });
+    }
+
+    for (auto& worker: workers)
+    {
+        worker.join();
+    }
+
+    size_t num_visible = 0;
+
+    for (std::uint64_t word: bits)
+    {
+        for (; word; word &= word - 1)
+        {
+            ++num_visible;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LOG_INIT_COUT();
+    log(LOG_INFO) << "Baked " << total_cells << " view cells (" << num_cells[0] << "x" << num_cells[1] << "x" << num_cells[2] << ") in " << seconds
+                  << " s on " << num_workers << " threads, " << double(num_visible) / total_cells << " of " << num_items << " items potentially visible per cell\n";
+
+    return true;
+}
+
+void PotentiallyVisibleSet::bake_cell(const DrawList& draw_list, size_t cell, const glm::mat4& projection, SoftwareOcclusion& occlusion) noexcept
+{
+    const auto& items = draw_list.get_items();
+    std::uint64_t* cell_bits = &bits[cell * words_per_cell];
+
+    auto set = [cell_bits](size_t item) { cell_bits[item / 64] |= std::uint64_t{1} << (item % 64); };
+    auto is_set = [cell_bits](size_t item) { return ((cell_bits[item / 64] >> (item % 64)) & 1u) != 0; };
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        if (!items[i].is_static)
+        {
+            set(i);
+        }
+    }
+
+    glm::vec3 cell_min = origin + glm::vec3{
+        GLfloat(cell % num_cells[0]),
+        GLfloat(cell / num_cells[0] % num_cells[1]),
+        GLfloat(cell / (size_t(num_cells[0]) * num_cells[1]))
+    } * CELL_SIZE;
+
+    // Corners and faces of the cell included, the camera may stand on them
+    GLfloat spacing = CELL_SIZE / (SAMPLES_PER_AXIS - 1);
+
+    for (size_t sample = 0; sample < SAMPLES_PER_AXIS * SAMPLES_PER_AXIS * SAMPLES_PER_AXIS; ++sample)
+    {
+        glm::vec3 point = cell_min + glm::vec3{
+            GLfloat(sample % SAMPLES_PER_AXIS),
+            GLfloat(sample / SAMPLES_PER_AXIS % SAMPLES_PER_AXIS),
+            GLfloat(sample / (SAMPLES_PER_AXIS * SAMPLES_PER_AXIS))
+        } * spacing;
+
+        for (const auto& [direction, up]: CUBE_FACES)
+        {
+            glm::mat4 view_projection = projection * glm::lookAt(point, point + direction, up);
+            Frustum frustum{view_projection};
+
+            // Whatever moves would only hide items from one frame to the next
+            occlusion.render(draw_list, view_projection, true);
+
+            for (size_t i = 0; i < items.size(); ++i)
+            {
+                if (!is_set(i) && frustum.intersects(items[i].bounds) && occlusion.is_visible(items[i].bounds))
+                {
+                    set(i);
+                }
+            }
+        }
+    }
+}
+
+bool PotentiallyVisibleSet::save(const std::filesystem::path& path) const noexcept
+{
+    std::ofstream out_stream{path, std::ios::binary};
+
+    std::uint64_t items_count = num_items;
+    std::uint32_t cell_size = CELL_SIZE_MILLIMETRES;
+
+    out_stream.write(FILE_MAGIC.data(), FILE_MAGIC.size());
+    out_stream.write(reinterpret_cast<const char*>(&items_count), sizeof(items_count));
+    out_stream.write(reinterpret_cast<const char*>(&cell_size), sizeof(cell_size));
+    out_stream.write(reinterpret_cast<const char*>(&origin[0]), 3 * sizeof(GLfloat));
+    out_stream.write(reinterpret_cast<const char*>(num_cells.data()), sizeof(num_cells));
+    out_stream.write(reinterpret_cast<const char*>(bits.data()), bits.size() * sizeof(std::uint64_t));
+
+    if (!out_stream)
+    {
+        LOG_INIT_CERR();
+        log(LOG_ERR) << "Could not write " << path << "\n";
+        return false;
+    }
+
+    LOG_INIT_COUT();
+    log(LOG_INFO) << "Potentially visible sets written to " << path << " (" << bits.size() * sizeof(std::uint64_t) << " bytes of bitsets)\n";
+
+    return true;
+}
+
+bool PotentiallyVisibleSet::load(const std::filesystem::path& path, const DrawList& draw_list) noexcept
+{
+    LOG_INIT_CERR();
+
+    std::ifstream in_stream{path, std::ios::binary};
+
+    if (!in_stream)
+    {
+        log(LOG_WARN) << "No potentially visible sets at " << path << ", run with --bake-pvs to bake them\n";
+        return false;
+    }
+
+    std::array<char, 4> magic{};
+    std::uint64_t items_count{0};
+    std::uint32_t cell_size{0};
+    glm::vec3 file_origin{0.f};
+    std::array<GLuint, 3> file_cells{0, 0, 0};
+
+    in_stream.read(magic.data(), magic.size());
+    in_stream.read(reinterpret_cast<char*>(&items_count), sizeof(items_count));
+    in_stream.read(reinterpret_cast<char*>(&cell_size), sizeof(cell_size));
+    in_stream.read(reinterpret_cast<char*>(&file_origin[0]), 3 * sizeof(GLfloat));
+    in_stream.read(reinterpret_cast<char*>(file_cells.data()), sizeof(file_cells));
+
+    if (!in_stream || magic != FILE_MAGIC || cell_size != CELL_SIZE_MILLIMETRES)
+    {
+        log(LOG_ERR) << "File " << path << " holds no potentially visible sets of this version\n";
+        return false;
+    }
+
+    if (items_count != draw_list.get_items().size())
+    {
+        log(LOG_ERR) << "Potentially visible sets of " << path << " were baked for " << items_count << " items, the scene has "
+                     << draw_list.get_items().size() << "; bake them again\n";
+        return false;
+    }
+
+    // Checked axis by axis, so neither the product nor the allocation can run away
+    size_t total_cells = 1;
+
+    for (GLuint cells: file_cells)
+    {
+        if (cells == 0 || cells > MAX_CELLS / total_cells)
+        {
+            log(LOG_ERR) << "File " << path << " is damaged, its grid is " << file_cells[0] << "x" << file_cells[1] << "x" << file_cells[2] << " cells\n";
+            return false;
+        }
+
+        total_cells *= cells;
+    }
+
+    std::vector<std::uint64_t> file_bits(total_cells * ((items_count + 63) / 64));
+    in_stream.read(reinterpret_cast<char*>(file_bits.data()), file_bits.size() * sizeof(std::uint64_t));
+
+    if (!in_stream)
+    {
+        log(LOG_ERR) << "File " << path << " is truncated\n";
+        return false;
+    }
+
+    origin = file_origin;
+    num_cells = file_cells;
+    num_items = items_count;
+    words_per_cell = (num_items + 63) / 64;
+    bits = std::move(file_bits);
+    current = nullptr;
+
+    return true;
+}
+
+void PotentiallyVisibleSet::set_position(const glm::vec3& position) noexcept
+{
+    current = nullptr;
+
+    if (bits.empty())
+    {
+        return;
+    }
+
+    glm::vec3 local = (position - origin) / CELL_SIZE;
+    std::array<size_t, 3> cell;
+
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        if (local[axis] < 0.f || local[axis] >= GLfloat(num_cells[axis]))
+        {
+            return;
+        }
+
+        cell[axis] = size_t(local[axis]);
+    }
+
+    current = &bits[((cell[2] * num_cells[1] + cell[1]) * num_cells[0] + cell[0]) * words_per_cell];
+}
\ No newline at end of file
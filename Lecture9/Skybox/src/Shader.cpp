@@ -30,6 +30,21 @@ std::shared_ptr<Shader> Shader::create_from_files(std::filesystem::path vertex_s
     return create_from_strings(vertex_shader_code, geometry_shader_code, fragment_shader_code);
 }
 
+std::shared_ptr<Shader> Shader::create_depth_only_from_files(std::filesystem::path vertex_shader_path, std::filesystem::path geometry_shader_path) noexcept
+{
+    std::string vertex_shader_code = read_file(vertex_shader_path);
+    std::string geometry_shader_code = geometry_shader_path.empty() ? "" : read_file(geometry_shader_path);
+    return create_from_strings(vertex_shader_code, geometry_shader_code, "");
+}
+
+std::shared_ptr<Shader> Shader::create_compute_from_file(std::filesystem::path compute_shader_path) noexcept
+{
+    std::string compute_shader_code = read_file(compute_shader_path);
+    auto shader = std::make_shared<Shader>();
+    shader->create_program("", "", "", compute_shader_code);
+    return shader;
+}
+
 void Shader::use() const noexcept
 {
     glUseProgram(program_id);
@@ -40,7 +55,7 @@ void Shader::set_directional_light(std::shared_ptr<DirectionalLight> light) cons
     light->use(uniform_directional_light.uniform_color_id, uniform_directional_light.uniform_ambient_intensity_id, uniform_directional_light.uniform_diffuse_intensity_id, uniform_directional_light.uniform_direction_id);
 }
 
-void Shader::set_point_lights(const std::vector<std::shared_ptr<PointLight>>& lights, unsigned int texture_unit, size_t offset) const noexcept
+void Shader::set_point_lights(const std::vector<std::shared_ptr<PointLight>>& lights, unsigned int texture_unit) const noexcept
 {
     size_t num_lights = std::min(MAX_POINT_LIGHTS, lights.size());
     glUniform1i(uniform_num_point_lights, num_lights);
@@ -50,13 +65,22 @@ void Shader::set_point_lights(const std::vector<std::shared_ptr<PointLight>>& li
                        uniform_point_lights[i].uniform_diffuse_intensity_id, uniform_point_lights[i].uniform_position_id,
                        uniform_point_lights[i].uniform_a_id, uniform_point_lights[i].uniform_b_id, uniform_point_lights[i].uniform_c_id);
         
-        lights[i]->get_shadow_map()->read(GL_TEXTURE0 + texture_unit + i);
-        glUniform1i(uniform_omnidirectional_shadow_maps[i + offset].uniform_shadow_map_id, texture_unit + i);
-        glUniform1f(uniform_omnidirectional_shadow_maps[i + offset].uniform_far_plane_id, lights[i]->get_far_plane());
+        auto shadow_map = std::static_pointer_cast<OmnidirectionalShadowMap>(lights[i]->get_shadow_map());
+        glUniform1i(uniform_omnidirectional_shadow_maps[i].uniform_cube_id, lights[i]->is_shadowed() ? shadow_map->get_cube() : -1);
+        glUniform1f(uniform_omnidirectional_shadow_maps[i].uniform_near_plane_id, lights[i]->get_near_plane());
+        glUniform1f(uniform_omnidirectional_shadow_maps[i].uniform_far_plane_id, lights[i]->get_far_plane());
     }
+
+    // Every cube lives in the same array, so one unit serves all the lights
+    if (num_lights > 0)
+    {
+        lights[0]->get_shadow_map()->read(GL_TEXTURE0 + texture_unit);
+    }
+
+    glUniform1i(uniform_omnidirectional_shadow_map_array_id, texture_unit);
 }
 
-void Shader::set_spot_lights(const std::vector<std::shared_ptr<SpotLight>>& lights, unsigned int texture_unit, size_t offset) const noexcept
+void Shader::set_spot_lights(const std::vector<std::shared_ptr<SpotLight>>& lights, const LightTable& table, unsigned int texture_unit) const noexcept
 {
     size_t num_lights = std::min(MAX_SPOT_LIGHTS, lights.size());
     glUniform1i(uniform_num_spot_lights, num_lights);
@@ -67,13 +91,21 @@ void Shader::set_spot_lights(const std::vector<std::shared_ptr<SpotLight>>& ligh
                        uniform_spot_lights[i].uniform_a_id, uniform_spot_lights[i].uniform_b_id, uniform_spot_lights[i].uniform_c_id,
                        uniform_spot_lights[i].uniform_direction_id, uniform_spot_lights[i].uniform_edge_id);
 
-        lights[i]->get_shadow_map()->read(GL_TEXTURE0 + texture_unit + i);
-        glUniform1i(uniform_omnidirectional_shadow_maps[i + offset].uniform_shadow_map_id, texture_unit + i);
-        glUniform1f(uniform_omnidirectional_shadow_maps[i + offset].uniform_far_plane_id, lights[i]->get_far_plane());
+        auto shadow_map = std::static_pointer_cast<AtlasShadowMap>(lights[i]->get_shadow_map());
+        glUniform4fv(uniform_spot_shadow_maps[i].uniform_uv_scale_offset_id, 1, glm::value_ptr(shadow_map->get_uv_scale_offset()));
+        glUniformMatrix4fv(uniform_spot_shadow_maps[i].uniform_light_transform_id, 1, GL_FALSE, glm::value_ptr(table.get_spot_light_transform(i)));
     }
+
+    // All the spot lights share the shadow atlas
+    if (num_lights > 0)
+    {
+        lights[0]->get_shadow_map()->read(GL_TEXTURE0 + texture_unit);
+    }
+
+    glUniform1i(uniform_spot_shadow_atlas_id, texture_unit);
 }
 
-void Shader::set_omnidirectional_light_matrices(const std::vector<glm::mat4>& matrices) const noexcept
+void Shader::set_omnidirectional_light_matrices(const LightTable::FaceTransforms& matrices) const noexcept
 {
     for (size_t i = 0; i < OmnidirectionalShadowMap::NUM_FACES; ++i)
     {
@@ -81,22 +113,176 @@ void Shader::set_omnidirectional_light_matrices(const std::vector<glm::mat4>& ma
     }
 }
 
+void Shader::set_omnidirectional_layer_offset(GLint layer_offset) const noexcept
+{
+    glUniform1i(uniform_layer_offset_id, layer_offset);
+}
+
+void Shader::set_omnidirectional_face(GLint face) const noexcept
+{
+    glUniform1i(uniform_face_id, face);
+}
+
+void Shader::set_shadow_filter(GLint texture_unit, GLint source_layer, const glm::vec2& texel_step, bool convert_depth) const noexcept
+{
+    glUniform1i(uniform_source_id, texture_unit);
+    glUniform1i(uniform_source_layer_id, source_layer);
+    glUniform2fv(uniform_texel_step_id, 1, glm::value_ptr(texel_step));
+    glUniform1i(uniform_convert_depth_id, convert_depth);
+}
+
+void Shader::set_shadow_filter_mode(GLint mode) const noexcept
+{
+    glUniform1i(uniform_shadow_filter_mode_id, mode);
+}
+
+void Shader::set_directional_moments(GLint texture_unit) const noexcept
+{
+    glUniform1i(uniform_directional_moments_id, texture_unit);
+}
+
+void Shader::set_omnidirectional_moments(GLint texture_unit) const noexcept
+{
+    glUniform1i(uniform_omnidirectional_moments_id, texture_unit);
+}
+
+void Shader::set_pcf_mode(GLint mode) const noexcept
+{
+    glUniform1i(uniform_pcf_mode_id, mode);
+}
+
+void Shader::set_show_shadow_samples(bool show) const noexcept
+{
+    glUniform1i(uniform_show_shadow_samples_id, show);
+}
+
+void Shader::set_omnidirectional_hardware_depth(bool hardware_depth) const noexcept
+{
+    glUniform1i(uniform_omnidirectional_hardware_depth_id, hardware_depth);
+}
+
+void Shader::set_shadow_mask_reconstruction(GLuint depth_texture_unit, const glm::mat4& inverse_view_projection) const noexcept
+{
+    glUniform1i(uniform_scene_depth_id, depth_texture_unit);
+    glUniformMatrix4fv(uniform_inverse_view_projection_id, 1, GL_FALSE, glm::value_ptr(inverse_view_projection));
+}
+
+void Shader::set_shadow_mask(bool enabled, GLuint mask_texture_unit, GLuint depth_texture_unit, const glm::vec2& scale) const noexcept
+{
+    glUniform1i(uniform_shadow_mask_enabled_id, enabled);
+    glUniform1i(uniform_shadow_mask_id, mask_texture_unit);
+    glUniform1i(uniform_shadow_mask_depth_id, depth_texture_unit);
+    glUniform2fv(uniform_shadow_mask_scale_id, 1, glm::value_ptr(scale));
+}
+
+void Shader::set_gbuffer(GLuint albedo_specular_texture_unit, GLuint normal_shininess_texture_unit, GLuint depth_texture_unit,
+                         const glm::mat4& inverse_view_projection) const noexcept
+{
+    glUniform1i(uniform_gbuffer_albedo_specular_id, albedo_specular_texture_unit);
+    glUniform1i(uniform_gbuffer_normal_shininess_id, normal_shininess_texture_unit);
+    glUniform1i(uniform_gbuffer_depth_id, depth_texture_unit);
+    glUniformMatrix4fv(uniform_inverse_view_projection_id, 1, GL_FALSE, glm::value_ptr(inverse_view_projection));
+}
+
+void Shader::set_light_clusters(GLuint lights_texture_unit, GLuint table_texture_unit, GLuint indices_texture_unit,
+                                GLuint num_point_lights, const glm::vec2& tile_scale, const glm::vec2& depth_slicing) const noexcept
+{
+    glUniform1i(uniform_cluster_lights_id, lights_texture_unit);
+    glUniform1i(uniform_cluster_table_id, table_texture_unit);
+    glUniform1i(uniform_cluster_light_indices_id, indices_texture_unit);
+    glUniform1i(uniform_num_cluster_point_lights_id, num_point_lights);
+    glUniform2fv(uniform_cluster_tile_scale_id, 1, glm::value_ptr(tile_scale));
+    glUniform2fv(uniform_cluster_depth_slicing_id, 1, glm::value_ptr(depth_slicing));
+}
+
+void Shader::set_bounds(const glm::vec3& bounds_min, const glm::vec3& bounds_max) const noexcept
+{
+    glUniform3fv(uniform_bounds_min_id, 1, glm::value_ptr(bounds_min));
+    glUniform3fv(uniform_bounds_max_id, 1, glm::value_ptr(bounds_max));
+}
+
+void Shader::set_depth_reduction(GLuint source_texture_unit, GLint source_level) const noexcept
+{
+    glUniform1i(uniform_source_id, source_texture_unit);
+    glUniform1i(uniform_source_level_id, source_level);
+}
+
+void Shader::set_culling(GLuint num_objects, const std::array<glm::vec4, 6>& frustum_planes) const noexcept
+{
+    glUniform1ui(uniform_num_objects_id, num_objects);
+    glUniform4fv(uniform_frustum_planes_id, frustum_planes.size(), glm::value_ptr(frustum_planes[0]));
+}
+
+void Shader::set_occlusion_culling(bool enabled, GLuint depth_pyramid_texture_unit, const glm::mat4& view_projection,
+                                   const glm::ivec2& depth_size, GLint num_levels) const noexcept
+{
+    glUniform1i(uniform_occlusion_culling_id, enabled);
+    glUniform1i(uniform_depth_pyramid_id, depth_pyramid_texture_unit);
+    glUniformMatrix4fv(uniform_pyramid_view_projection_id, 1, GL_FALSE, glm::value_ptr(view_projection));
+    glUniform2i(uniform_depth_size_id, depth_size.x, depth_size.y);
+    glUniform1i(uniform_pyramid_levels_id, num_levels);
+}
+
+void Shader::set_depth_linearization(bool hardware_depth, GLfloat near_plane, GLfloat far_plane) const noexcept
+{
+    glUniform1i(uniform_hardware_depth_id, hardware_depth);
+    glUniform1f(uniform_near_plane_id, near_plane);
+    glUniform1f(uniform_far_plane_id, far_plane);
+}
+
+void Shader::set_directional_shadow_comparison(GLint texture_unit) const noexcept
+{
+    glUniform1i(uniform_directional_shadow_comparison_id, texture_unit);
+}
+
+void Shader::set_spot_shadow_comparison(GLint texture_unit) const noexcept
+{
+    glUniform1i(uniform_spot_shadow_comparison_id, texture_unit);
+}
+
 void Shader::set_texture(GLenum texture_unit) const noexcept
 {
     glUniform1i(uniform_texture_id, texture_unit);
 }
 
+void Shader::set_draw_data(GLuint texture_unit) const noexcept
+{
+    glUniform1i(uniform_draw_data_id, texture_unit);
+}
+
 void Shader::set_directional_shadow_map(GLenum texture_unit) const noexcept
 {
     glUniform1i(uniform_directional_shadow_map_id, texture_unit);
 }
 
-void Shader::set_directional_light_space_transform(const glm::mat4& directional_light_space_transform) const noexcept
+void Shader::set_light_space_transform(const glm::mat4& light_space_transform) const noexcept
+{
+    glUniformMatrix4fv(uniform_light_space_transform_id, 1, GL_FALSE, glm::value_ptr(light_space_transform));
+}
+
+void Shader::set_directional_light_space_transforms(const std::vector<glm::mat4>& directional_light_space_transforms) const noexcept
+{
+    size_t num_cascades = std::min(CascadedShadowMap::MAX_CASCADES, directional_light_space_transforms.size());
+    glUniform1i(uniform_num_cascades_id, num_cascades);
+
+    for (size_t i = 0; i < num_cascades; ++i)
+    {
+        glUniformMatrix4fv(uniform_directional_light_space_transform_ids[i], 1, GL_FALSE, glm::value_ptr(directional_light_space_transforms[i]));
+    }
+}
+
+void Shader::set_cascade_splits(const std::vector<GLfloat>& cascade_splits) const noexcept
 {
-    glUniformMatrix4fv(uniform_directional_light_space_transform_id, 1, GL_FALSE, glm::value_ptr(directional_light_space_transform));
+    size_t num_cascades = std::min(CascadedShadowMap::MAX_CASCADES, cascade_splits.size());
+
+    for (size_t i = 0; i < num_cascades; ++i)
+    {
+        glUniform1f(uniform_cascade_split_ids[i], cascade_splits[i]);
+    }
 }
 
-void Shader::create_program(std::string_view vertex_shader_code, std::string_view geometry_shader_code, std::string_view fragment_shader_code) noexcept
+void Shader::create_program(std::string_view vertex_shader_code, std::string_view geometry_shader_code, std::string_view fragment_shader_code,
+                            std::string_view compute_shader_code) noexcept
 {
     LOG_INIT_CERR();
 
@@ -111,6 +297,7 @@ void Shader::create_program(std::string_view vertex_shader_code, std::string_vie
     create_shader(vertex_shader_code, GL_VERTEX_SHADER);
     create_shader(geometry_shader_code, GL_GEOMETRY_SHADER);
     create_shader(fragment_shader_code, GL_FRAGMENT_SHADER);
+    create_shader(compute_shader_code, GL_COMPUTE_SHADER);
 
     glLinkProgram(program_id);
 
@@ -135,7 +322,6 @@ void Shader::create_program(std::string_view vertex_shader_code, std::string_vie
         log(LOG_ERR) << "Error validating the program: " << log_text << " \n";
     }
 
-    uniform_model_id = glGetUniformLocation(program_id, "model");
     uniform_view_id = glGetUniformLocation(program_id, "view");
     uniform_projection_id = glGetUniformLocation(program_id, "projection");
     uniform_eye_position_id = glGetUniformLocation(program_id, "eye_position");
@@ -143,15 +329,58 @@ void Shader::create_program(std::string_view vertex_shader_code, std::string_vie
     uniform_directional_light.uniform_color_id = glGetUniformLocation(program_id, "directional_light.base.color");
     uniform_directional_light.uniform_diffuse_intensity_id = glGetUniformLocation(program_id, "directional_light.base.diffuse_intensity");
     uniform_directional_light.uniform_direction_id = glGetUniformLocation(program_id, "directional_light.direction");
-    uniform_specular_intensity_id = glGetUniformLocation(program_id, "material.specular_intensity");
-    uniform_specular_shininess_id = glGetUniformLocation(program_id, "material.shininess");
     uniform_num_point_lights = glGetUniformLocation(program_id, "num_point_lights");
     uniform_num_spot_lights = glGetUniformLocation(program_id, "num_spot_lights");
-    uniform_directional_light_space_transform_id = glGetUniformLocation(program_id, "directional_light_space_transform");
+    uniform_light_space_transform_id = glGetUniformLocation(program_id, "light_space_transform");
     uniform_directional_shadow_map_id = glGetUniformLocation(program_id, "directional_shadow_map");
+    uniform_num_cascades_id = glGetUniformLocation(program_id, "num_cascades");
     uniform_texture_id = glGetUniformLocation(program_id, "the_texture");
+    uniform_draw_data_id = glGetUniformLocation(program_id, "draw_data");
     uniform_omnidirectional_light_position_id = glGetUniformLocation(program_id, "light_position");
     uniform_far_plane_id = glGetUniformLocation(program_id, "far_plane");
+    uniform_face_id = glGetUniformLocation(program_id, "face");
+    uniform_layer_offset_id = glGetUniformLocation(program_id, "layer_offset");
+    uniform_spot_shadow_atlas_id = glGetUniformLocation(program_id, "spot_shadow_atlas");
+    uniform_source_id = glGetUniformLocation(program_id, "source");
+    uniform_source_layer_id = glGetUniformLocation(program_id, "source_layer");
+    uniform_texel_step_id = glGetUniformLocation(program_id, "texel_step");
+    uniform_convert_depth_id = glGetUniformLocation(program_id, "convert_depth");
+    uniform_shadow_filter_mode_id = glGetUniformLocation(program_id, "shadow_filter_mode");
+    uniform_directional_moments_id = glGetUniformLocation(program_id, "directional_moments");
+    uniform_omnidirectional_moments_id = glGetUniformLocation(program_id, "omnidirectional_moment_array");
+    uniform_pcf_mode_id = glGetUniformLocation(program_id, "pcf_mode");
+    uniform_show_shadow_samples_id = glGetUniformLocation(program_id, "show_shadow_samples");
+    uniform_omnidirectional_hardware_depth_id = glGetUniformLocation(program_id, "omnidirectional_hardware_depth");
+    uniform_hardware_depth_id = glGetUniformLocation(program_id, "hardware_depth");
+    uniform_near_plane_id = glGetUniformLocation(program_id, "near_plane");
+    uniform_scene_depth_id = glGetUniformLocation(program_id, "scene_depth");
+    uniform_inverse_view_projection_id = glGetUniformLocation(program_id, "inverse_view_projection");
+    uniform_shadow_mask_enabled_id = glGetUniformLocation(program_id, "shadow_mask_enabled");
+    uniform_shadow_mask_id = glGetUniformLocation(program_id, "shadow_mask");
+    uniform_shadow_mask_depth_id = glGetUniformLocation(program_id, "shadow_mask_depth");
+    uniform_shadow_mask_scale_id = glGetUniformLocation(program_id, "shadow_mask_scale");
+    uniform_gbuffer_albedo_specular_id = glGetUniformLocation(program_id, "gbuffer_albedo_specular");
+    uniform_gbuffer_normal_shininess_id = glGetUniformLocation(program_id, "gbuffer_normal_shininess");
+    uniform_gbuffer_depth_id = glGetUniformLocation(program_id, "gbuffer_depth");
+    uniform_cluster_lights_id = glGetUniformLocation(program_id, "cluster_lights");
+    uniform_cluster_table_id = glGetUniformLocation(program_id, "cluster_table");
+    uniform_cluster_light_indices_id = glGetUniformLocation(program_id, "cluster_light_indices");
+    uniform_num_cluster_point_lights_id = glGetUniformLocation(program_id, "num_cluster_point_lights");
+    uniform_cluster_tile_scale_id = glGetUniformLocation(program_id, "cluster_tile_scale");
+    uniform_cluster_depth_slicing_id = glGetUniformLocation(program_id, "cluster_depth_slicing");
+    uniform_directional_shadow_comparison_id = glGetUniformLocation(program_id, "directional_shadow_comparison");
+    uniform_spot_shadow_comparison_id = glGetUniformLocation(program_id, "spot_shadow_comparison");
+    uniform_omnidirectional_shadow_map_array_id = glGetUniformLocation(program_id, "omnidirectional_shadow_map_array");
+    uniform_bounds_min_id = glGetUniformLocation(program_id, "bounds_min");
+    uniform_bounds_max_id = glGetUniformLocation(program_id, "bounds_max");
+    uniform_source_level_id = glGetUniformLocation(program_id, "source_level");
+    uniform_num_objects_id = glGetUniformLocation(program_id, "num_objects");
+    uniform_frustum_planes_id = glGetUniformLocation(program_id, "frustum_planes");
+    uniform_occlusion_culling_id = glGetUniformLocation(program_id, "occlusion_culling");
+    uniform_depth_pyramid_id = glGetUniformLocation(program_id, "depth_pyramid");
+    uniform_pyramid_view_projection_id = glGetUniformLocation(program_id, "pyramid_view_projection");
+    uniform_depth_size_id = glGetUniformLocation(program_id, "depth_size");
+    uniform_pyramid_levels_id = glGetUniformLocation(program_id, "pyramid_levels");
 
     for (size_t i = 0; i < MAX_POINT_LIGHTS; ++i)
     {
@@ -211,21 +440,44 @@ void Shader::create_program(std::string_view vertex_shader_code, std::string_vie
         uniform_spot_lights[i].uniform_edge_id = glGetUniformLocation(program_id, s9.str().c_str());
     }
 
-    for (size_t i = 0; i < MAX_POINT_LIGHTS + MAX_SPOT_LIGHTS; ++i)
+    for (size_t i = 0; i < MAX_POINT_LIGHTS; ++i)
     {
-        std::stringstream s1, s2;
-        s1 << "omnidirectional_shadow_maps[" << i << "]" << ".shadow_map";
-        uniform_omnidirectional_shadow_maps[i].uniform_shadow_map_id = glGetUniformLocation(program_id, s1.str().c_str());
+        std::stringstream s1, s2, s3;
+        s1 << "omnidirectional_shadow_maps[" << i << "]" << ".cube";
+        uniform_omnidirectional_shadow_maps[i].uniform_cube_id = glGetUniformLocation(program_id, s1.str().c_str());
         
-        s2 << "omnidirectional_shadow_maps[" << i << "]" << ".far_plane";
-        uniform_omnidirectional_shadow_maps[i].uniform_far_plane_id = glGetUniformLocation(program_id, s2.str().c_str());
+        s2 << "omnidirectional_shadow_maps[" << i << "]" << ".near_plane";
+        uniform_omnidirectional_shadow_maps[i].uniform_near_plane_id = glGetUniformLocation(program_id, s2.str().c_str());
+
+        s3 << "omnidirectional_shadow_maps[" << i << "]" << ".far_plane";
+        uniform_omnidirectional_shadow_maps[i].uniform_far_plane_id = glGetUniformLocation(program_id, s3.str().c_str());
+    }
+
+    for (size_t i = 0; i < MAX_SPOT_LIGHTS; ++i)
+    {
+        std::stringstream s1, s2;
+        s1 << "spot_shadow_maps[" << i << "]" << ".uv_scale_offset";
+        uniform_spot_shadow_maps[i].uniform_uv_scale_offset_id = glGetUniformLocation(program_id, s1.str().c_str());
+
+        s2 << "spot_shadow_maps[" << i << "]" << ".light_transform";
+        uniform_spot_shadow_maps[i].uniform_light_transform_id = glGetUniformLocation(program_id, s2.str().c_str());
+    }
+
+    for (size_t i = 0; i < CascadedShadowMap::MAX_CASCADES; ++i)
+    {
+        std::stringstream s1, s2;
+        s1 << "directional_light_space_transforms[" << i << "]";
+        uniform_directional_light_space_transform_ids[i] = glGetUniformLocation(program_id, s1.str().c_str());
+
+        s2 << "cascade_splits[" << i << "]";
+        uniform_cascade_split_ids[i] = glGetUniformLocation(program_id, s2.str().c_str());
     }
 
     for (size_t i = 0; i < OmnidirectionalShadowMap::NUM_FACES; ++i)
     {
-        std::stringstream s;
-        s << "light_matrices[" << i << "]";
-        uniform_light_matrix_ids[i] = glGetUniformLocation(program_id, s.str().c_str());
+        std::stringstream s1;
+        s1 << "light_matrices[" << i << "]";
+        uniform_light_matrix_ids[i] = glGetUniformLocation(program_id, s1.str().c_str());
     }
 }
 
@@ -286,9 +538,19 @@ std::string Shader::read_file(const std::filesystem::path& shader_path) noexcept
         return "";
     }
 
+    // #include "file" pulls in code shared between programs, relative to the including file
+    const std::string include_directive{"#include \""};
+
     std::string line;
     while (std::getline(in_stream, line))
     {
+        if (line.compare(0, include_directive.size(), include_directive) == 0)
+        {
+            auto end = line.find('"', include_directive.size());
+            contents.append(read_file(shader_path.parent_path() / line.substr(include_directive.size(), end - include_directive.size())));
+            continue;
+        }
+
         contents.append(line + "\n");
     }
 
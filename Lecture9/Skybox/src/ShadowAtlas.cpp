@@ -0,0 +1,189 @@
+#include <ShadowAtlas.hpp>
+
+namespace
+{
+    GLuint bytes_per_texel(ShadowAtlas::DepthFormat format) noexcept
+    {
+        // 24-bit depth is stored in 32 bits by every driver
+        return format == ShadowAtlas::DepthFormat::DEPTH16 ? 2 : 4;
+    }
+
+    GLenum internal_format(ShadowAtlas::DepthFormat format) noexcept
+    {
+        switch (format)
+        {
+            case ShadowAtlas::DepthFormat::DEPTH16:
+                return GL_DEPTH_COMPONENT16;
+
+            case ShadowAtlas::DepthFormat::DEPTH24:
+                return GL_DEPTH_COMPONENT24;
+
+            default:
+                return GL_DEPTH_COMPONENT32F;
+        }
+    }
+
+    // Keeps the even bits of a Morton code: the x (or y) cell of a quadtree node
+    GLuint compact_bits(GLuint value) noexcept
+    {
+        value &= 0x55555555;
+        value = (value | (value >> 1)) & 0x33333333;
+        value = (value | (value >> 2)) & 0x0f0f0f0f;
+        value = (value | (value >> 4)) & 0x00ff00ff;
+        value = (value | (value >> 8)) & 0x0000ffff;
+        return value;
+    }
+
+    GLuint next_power_of_two(GLuint value) noexcept
+    {
+        GLuint result = 1;
+
+        while (result < value)
+        {
+            result <<= 1;
+        }
+
+        return result;
+    }
+}
+
+ShadowAtlas::Settings ShadowAtlas::get_settings(Quality quality) noexcept
+{
+    switch (quality)
+    {
+        case Quality::LOW:
+            return Settings{DepthFormat::DEPTH16, 8 << 20, 64};
+
+        case Quality::MEDIUM:
+            return Settings{DepthFormat::DEPTH24, 16 << 20, 64};
+
+        default:
+            return Settings{DepthFormat::DEPTH32F, 64 << 20, 128};
+    }
+}
+
+ShadowAtlas::ShadowAtlas(const Settings& _settings) noexcept
+    : settings{_settings}
+{
+
+}
+
+ShadowAtlas::~ShadowAtlas()
+{
+    glDeleteFramebuffers(1, &FBO_id);
+    glDeleteTextures(1, &shadow_map_id);
+}
+
+bool ShadowAtlas::init() noexcept
+{
+    GLint max_size{0};
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+
+    // Largest power of two that fits in the memory budget
+    size = settings.min_tile_size;
+
+    while (2 * size <= GLuint(max_size) && size_t(4) * size * size * bytes_per_texel(settings.depth_format) <= settings.memory_budget)
+    {
+        size *= 2;
+    }
+
+    glGenFramebuffers(1, &FBO_id);
+
+    glGenTextures(1, &shadow_map_id);
+    glBindTexture(GL_TEXTURE_2D, shadow_map_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format(settings.depth_format), size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO_id);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, shadow_map_id, 0);
+
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG_INIT_CERR();
+        log(LOG_ERR) << "Framebuffer error: " << status << "\n";
+        return false;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    return true;
+}
+
+GLuint ShadowAtlas::get_tile_size(GLfloat coverage, GLuint screen_height) const noexcept
+{
+    if (coverage <= 0.f)
+    {
+        return 0;
+    }
+
+    // About one shadow texel per covered pixel, leaving room for at least four tiles
+    GLuint wanted = next_power_of_two(GLuint(coverage * screen_height));
+
+    return std::max(settings.min_tile_size, std::min(size / 2, wanted));
+}
+
+std::vector<ShadowAtlas::Tile> ShadowAtlas::allocate(const std::vector<GLuint>& requested_sizes) const noexcept
+{
+    std::vector<Tile> tiles(requested_sizes.size());
+
+    std::vector<size_t> order(requested_sizes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&requested_sizes](size_t i, size_t j) { return requested_sizes[i] > requested_sizes[j]; });
+
+    // Placing the largest tiles first keeps the Morton cursor aligned to
+    // every later tile, so the cursor walks the quadtree without gaps.
+    GLuint cells_per_side = size / settings.min_tile_size;
+    size_t total_cells = size_t(cells_per_side) * cells_per_side;
+    size_t cursor = 0;
+
+    for (auto i: order)
+    {
+        GLuint tile_size = std::min(size, requested_sizes[i]);
+
+        while (tile_size >= settings.min_tile_size)
+        {
+            size_t tile_cells_per_side = tile_size / settings.min_tile_size;
+            size_t tile_cells = tile_cells_per_side * tile_cells_per_side;
+
+            if (cursor + tile_cells <= total_cells)
+            {
+                tiles[i].x = compact_bits(cursor) * settings.min_tile_size;
+                tiles[i].y = compact_bits(cursor >> 1) * settings.min_tile_size;
+                tiles[i].size = tile_size;
+                cursor += tile_cells;
+                break;
+            }
+
+            tile_size /= 2;
+        }
+    }
+
+    return tiles;
+}
+
+void ShadowAtlas::write(const Tile& tile) const noexcept
+{
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, FBO_id);
+    glViewport(tile.x, tile.y, tile.size, tile.size);
+    glScissor(tile.x, tile.y, tile.size, tile.size);
+}
+
+void ShadowAtlas::read(GLenum texture_unit) const noexcept
+{
+    glActiveTexture(texture_unit);
+    glBindTexture(GL_TEXTURE_2D, shadow_map_id);
+}
+
+glm::vec4 ShadowAtlas::get_uv_scale_offset(const Tile& tile) const noexcept
+{
+    GLfloat inverse_size = 1.f / GLfloat(size);
+    return glm::vec4{tile.size * inverse_size, tile.size * inverse_size, tile.x * inverse_size, tile.y * inverse_size};
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include <ShadowFilter.hpp>
+
+ShadowFilter::ShadowFilter(std::shared_ptr<Shader> _evsm_shader, std::shared_ptr<Shader> _esm_shader) noexcept
+    : evsm_shader{_evsm_shader}, esm_shader{_esm_shader}
+{
+
+}
+
+ShadowFilter::~ShadowFilter()
+{
+    glDeleteFramebuffers(1, &FBO_id);
+    glDeleteVertexArrays(1, &VAO_id);
+
+    if (evsm_temporary.texture_id)
+    {
+        glDeleteTextures(1, &evsm_temporary.texture_id);
+    }
+
+    if (esm_temporary.texture_id)
+    {
+        glDeleteTextures(1, &esm_temporary.texture_id);
+    }
+}
+
+bool ShadowFilter::init() noexcept
+{
+    glGenFramebuffers(1, &FBO_id);
+
+    // The passes draw a fullscreen triangle built from gl_VertexID, but a core context still needs a VAO
+    glGenVertexArrays(1, &VAO_id);
+
+    return FBO_id != 0 && VAO_id != 0;
+}
+
+void ShadowFilter::resize_temporary(Temporary& temporary, GLenum target, GLenum internal_format, GLenum format, GLuint w, GLuint h, GLuint layers) noexcept
+{
+    if (temporary.texture_id && temporary.width == w && temporary.height == h)
+    {
+        return;
+    }
+
+    if (temporary.texture_id)
+    {
+        glDeleteTextures(1, &temporary.texture_id);
+    }
+
+    temporary.width = w;
+    temporary.height = h;
+
+    glGenTextures(1, &temporary.texture_id);
+    glBindTexture(target, temporary.texture_id);
+    glTexImage3D(target, 0, internal_format, w, h, layers, 0, format, GL_FLOAT, nullptr);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+void ShadowFilter::begin() const noexcept
+{
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, FBO_id);
+    glDrawBuffer(GL_COLOR_ATTACHMENT0);
+    glBindVertexArray(VAO_id);
+    glDisable(GL_DEPTH_TEST);
+}
+
+void ShadowFilter::end() const noexcept
+{
+    glEnable(GL_DEPTH_TEST);
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ShadowFilter::filter(CascadedShadowMap& shadow_map) noexcept
+{
+    if (!shadow_map.init_moments())
+    {
+        return;
+    }
+
+    GLuint width = shadow_map.get_width();
+    GLuint height = shadow_map.get_height();
+    resize_temporary(evsm_temporary, GL_TEXTURE_2D_ARRAY, GL_RGBA32F, GL_RGBA, width, height, 1);
+
+    begin();
+    glViewport(0, 0, width, height);
+    evsm_shader->use();
+
+    for (GLuint cascade = 0; cascade < shadow_map.get_num_cascades(); ++cascade)
+    {
+        // Depth to moments, horizontal blur
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, evsm_temporary.texture_id, 0, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, shadow_map.get_shadow_map_id());
+        evsm_shader->set_shadow_filter(0, cascade, glm::vec2{1.f / width, 0.f}, true);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        // Vertical blur into the cascade's layer
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, shadow_map.get_moments_id(), 0, cascade);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, evsm_temporary.texture_id);
+        evsm_shader->set_shadow_filter(0, 0, glm::vec2{0.f, 1.f / height}, false);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    end();
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, shadow_map.get_moments_id());
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
+
+void ShadowFilter::filter(OmnidirectionalShadowMap& shadow_map, bool hardware_depth, GLfloat near_plane, GLfloat far_plane) noexcept
+{
+    if (!shadow_map.init_moments())
+    {
+        return;
+    }
+
+    auto storage = shadow_map.get_storage();
+    GLuint width = storage->get_width();
+    GLuint height = storage->get_height();
+    resize_temporary(esm_temporary, GL_TEXTURE_CUBE_MAP_ARRAY, GL_R32F, GL_RED, width, height, OmnidirectionalShadowMap::NUM_FACES);
+
+    begin();
+    glViewport(0, 0, width, height);
+    esm_shader->use();
+    esm_shader->set_depth_linearization(hardware_depth, near_plane, far_plane);
+
+    // Every face is read through its cube, so the blur crosses the seams.
+    // All six faces of a pass must be done before the next pass reads them.
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, storage->get_shadow_map_id());
+
+    for (size_t face = 0; face < OmnidirectionalShadowMap::NUM_FACES; ++face)
+    {
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, esm_temporary.texture_id, 0, face);
+        esm_shader->set_omnidirectional_face(face);
+        esm_shader->set_shadow_filter(0, shadow_map.get_cube(), glm::vec2{1.f / width, 0.f}, true);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, esm_temporary.texture_id);
+
+    for (size_t face = 0; face < OmnidirectionalShadowMap::NUM_FACES; ++face)
+    {
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, storage->get_moments_id(), 0, shadow_map.get_layer_offset() + face);
+        esm_shader->set_omnidirectional_face(face);
+        esm_shader->set_shadow_filter(0, 0, glm::vec2{0.f, 1.f / height}, false);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    end();
+
+    unmipmapped_storage = storage;
+}
+
+void ShadowFilter::generate_omnidirectional_mipmaps() noexcept
+{
+    if (!unmipmapped_storage)
+    {
+        return;
+    }
+
+    // Regenerates the mips of every cube in the array, there is no per-layer variant in GL 4.1,
+    // so it is done once for all lights instead of once per light
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, unmipmapped_storage->get_moments_id());
+    glGenerateMipmap(GL_TEXTURE_CUBE_MAP_ARRAY);
+
+    unmipmapped_storage = nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <ShadowMask.hpp>
+
+ShadowMask::ShadowMask(std::shared_ptr<Shader> _mask_shader) noexcept
+    : mask_shader{_mask_shader}
+{
+
+}
+
+ShadowMask::~ShadowMask()
+{
+    clear_targets();
+    glDeleteVertexArrays(1, &VAO_id);
+}
+
+bool ShadowMask::init(GLuint w, GLuint h, Resolution _resolution) noexcept
+{
+    width = w;
+    height = h;
+    resolution = _resolution;
+
+    // The mask is drawn as a fullscreen triangle built from gl_VertexID
+    glGenVertexArrays(1, &VAO_id);
+
+    return create_targets();
+}
+
+bool ShadowMask::set_resolution(Resolution _resolution) noexcept
+{
+    if (resolution == _resolution)
+    {
+        return true;
+    }
+
+    resolution = _resolution;
+
+    return create_targets();
+}
+
+bool ShadowMask::create_targets() noexcept
+{
+    LOG_INIT_CERR();
+
+    clear_targets();
+
+    mask_width = std::max(width / static_cast<GLuint>(resolution), 1u);
+    mask_height = std::max(height / static_cast<GLuint>(resolution), 1u);
+
+    // The upsampling picks its own texels and weights, so no filtering here
+    glGenTextures(1, &mask_id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, mask_id);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, mask_width, mask_height, NUM_LAYERS, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenTextures(1, &mask_depth_id);
+    glBindTexture(GL_TEXTURE_2D, mask_depth_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, mask_width, mask_height, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenFramebuffers(1, &mask_FBO_id);
+    glBindFramebuffer(GL_FRAMEBUFFER, mask_FBO_id);
+
+    std::array<GLenum, NUM_LAYERS + 1> draw_buffers;
+
+    for (size_t layer = 0; layer < NUM_LAYERS; ++layer)
+    {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + layer, mask_id, 0, layer);
+        draw_buffers[layer] = GL_COLOR_ATTACHMENT0 + layer;
+    }
+
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + NUM_LAYERS, mask_depth_id, 0);
+    draw_buffers[NUM_LAYERS] = GL_COLOR_ATTACHMENT0 + NUM_LAYERS;
+    glDrawBuffers(draw_buffers.size(), draw_buffers.data());
+
+    auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        log(LOG_ERR) << "Framebuffer error: " << status << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+void ShadowMask::clear_targets() noexcept
+{
+    glDeleteFramebuffers(1, &mask_FBO_id);
+    glDeleteTextures(1, &mask_id);
+    glDeleteTextures(1, &mask_depth_id);
+
+    mask_FBO_id = mask_id = mask_depth_id = 0;
+}
+
+void ShadowMask::evaluate(const glm::mat4& projection, const glm::mat4& view, GLuint depth_texture_id, GLuint depth_texture_unit) const noexcept
+{
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mask_FBO_id);
+    glViewport(0, 0, mask_width, mask_height);
+
+    glActiveTexture(GL_TEXTURE0 + depth_texture_unit);
+    glBindTexture(GL_TEXTURE_2D, depth_texture_id);
+    mask_shader->set_shadow_mask_reconstruction(depth_texture_unit, glm::inverse(projection * view));
+    glUniformMatrix4fv(mask_shader->get_uniform_view_id(), 1, GL_FALSE, glm::value_ptr(view));
+
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(VAO_id);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ShadowMask::read(GLenum mask_texture_unit, GLenum depth_texture_unit) const noexcept
+{
+    glActiveTexture(mask_texture_unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, mask_id);
+    glActiveTexture(depth_texture_unit);
+    glBindTexture(GL_TEXTURE_2D, mask_depth_id);
+}
+
+glm::vec2 ShadowMask::get_scale() const noexcept
+{
+    return glm::vec2{float(mask_width) / float(width), float(mask_height) / float(height)};
+}
\ No newline at end of file
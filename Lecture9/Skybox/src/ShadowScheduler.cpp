@@ -0,0 +1,66 @@
+#include <ShadowScheduler.hpp>
+
+ShadowScheduler::ShadowScheduler(GLuint _face_budget) noexcept
+    : face_budget{_face_budget}
+{
+
+}
+
+std::vector<std::shared_ptr<PointLight>> ShadowScheduler::schedule(const std::vector<std::shared_ptr<PointLight>>& lights, const std::vector<GLfloat>& coverages, const FaceCount& count_faces) noexcept
+{
+    std::unordered_map<const PointLight*, State> current_states;
+    std::vector<std::pair<GLfloat, size_t>> candidates;
+
+    for (size_t i = 0; i < lights.size(); ++i)
+    {
+        State state = states[lights[i].get()];
+
+        if (coverages[i] < MIN_COVERAGE)
+        {
+            lights[i]->set_shadowed(false);
+        }
+        else if (lights[i]->get_shadow_map()->is_dirty())
+        {
+            // A cube that was never rendered goes first, otherwise the light would stay unshadowed
+            GLfloat importance = state.rendered ? coverages[i] * (1 + state.frames_waiting) : std::numeric_limits<GLfloat>::max();
+            candidates.emplace_back(importance, i);
+        }
+        else
+        {
+            lights[i]->set_shadowed(state.rendered);
+        }
+
+        current_states[lights[i].get()] = state;
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto& p, const auto& q) { return p.first > q.first; });
+
+    std::vector<std::shared_ptr<PointLight>> scheduled;
+    GLuint faces = 0;
+
+    for (const auto& [importance, i]: candidates)
+    {
+        State& state = current_states[lights[i].get()];
+        GLuint light_faces = count_faces(i);
+
+        // The most important light always fits, even with a budget below its faces
+        if (scheduled.empty() || faces + light_faces <= face_budget)
+        {
+            scheduled.push_back(lights[i]);
+            faces += light_faces;
+            state.frames_waiting = 0;
+            state.rendered = true;
+        }
+        else
+        {
+            ++state.frames_waiting;
+        }
+
+        lights[i]->set_shadowed(state.rendered);
+    }
+
+    // Lights that were removed are forgotten
+    states = std::move(current_states);
+
+    return scheduled;
+}
\ No newline at end of file
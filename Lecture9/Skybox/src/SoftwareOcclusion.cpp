@@ -0,0 +1,368 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(SKYBOX_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <SoftwareOcclusion.hpp>
+
+SoftwareOcclusion::SoftwareOcclusion(std::string_view _name, GLuint w, GLuint h, bool _parallel) noexcept
+    : name{_name}, width{w}, height{h}, tiles_x{w / TILE_SIZE}, tiles_y{h / TILE_SIZE},
+      depth(w * h, 1.f), tile_depth(tiles_x * tiles_y, 1.f), workers{_parallel ? WorkerPool::get_instance() : nullptr}
+{
+
+}
+
+void SoftwareOcclusion::render(const DrawList& draw_list, const glm::mat4& _view_projection, bool static_only) noexcept
+{
+    view_projection = _view_projection;
+    triangles.clear();
+
+    for (const auto& item: draw_list.get_items())
+    {
+        if (!item.occluder || (static_only && !item.is_static))
+        {
+            continue;
+        }
+
+        glm::mat4 transform = view_projection * item.model;
+        const std::shared_ptr<Mesh>* meshes = item.mesh ? &item.mesh : item.scene_model->get_meshes().data();
+        size_t num_meshes = item.mesh ? 1 : item.scene_model->get_meshes().size();
+
+        for (size_t m = 0; m < num_meshes; ++m)
+        {
+            const std::vector<glm::vec3>& corners = meshes[m]->get_occluder_triangles();
+
+            for (size_t i = 0; i + 2 < corners.size(); i += 3)
+            {
+                add_triangle({transform * glm::vec4{corners[i], 1.f}, transform * glm::vec4{corners[i + 1], 1.f}, transform * glm::vec4{corners[i + 2], 1.f}});
+            }
+        }
+    }
+
+    num_triangles += triangles.size();
+
+    // Bands of whole tile rows, so no two workers touch the same tile
+    if (workers && triangles.size() >= PARALLEL_THRESHOLD)
+    {
+        size_t num_bands = std::min<size_t>(workers->get_num_workers(), tiles_y);
+        GLuint band_height = (tiles_y + num_bands - 1) / num_bands * TILE_SIZE;
+
+        workers->run((height + band_height - 1) / band_height, [this, band_height](size_t band) {
+            GLuint first_row = band * band_height;
+            rasterize_band(first_row, std::min(first_row + band_height, height));
+        });
+    }
+    else
+    {
+        rasterize_band(0, height);
+    }
+
+    rendered = true;
+}
+
+void SoftwareOcclusion::add_triangle(const std::array<glm::vec4, 3>& clip) noexcept
+{
+    // Near plane of the clip space, z >= -w; one plane turns a triangle into at most a quad
+    std::array<glm::vec4, 4> polygon;
+    size_t count = 0;
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const glm::vec4& a = clip[i];
+        const glm::vec4& b = clip[(i + 1) % 3];
+        GLfloat distance_a = a.z + a.w;
+        GLfloat distance_b = b.z + b.w;
+
+        if (distance_a >= 0.f)
+        {
+            polygon[count++] = a;
+        }
+
+        if ((distance_a >= 0.f) != (distance_b >= 0.f))
+        {
+            polygon[count++] = a + (b - a) * (distance_a / (distance_a - distance_b));
+        }
+    }
+
+    if (count < 3)
+    {
+        return;
+    }
+
+    std::array<glm::vec3, 4> screen;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const glm::vec4& v = polygon[i];
+
+        if (v.w <= 0.f)
+        {
+            return;
+        }
+
+        screen[i] = glm::vec3{(v.x / v.w * 0.5f + 0.5f) * width, (v.y / v.w * 0.5f + 0.5f) * height, v.z / v.w * 0.5f + 0.5f};
+    }
+
+    for (size_t i = 1; i + 1 < count; ++i)
+    {
+        setup_triangle(screen[0], screen[i], screen[i + 1]);
+    }
+}
+
+void SoftwareOcclusion::setup_triangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2) noexcept
+{
+    GLfloat area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+
+    // Twice the area: below one pixel it cannot cover a pixel whole
+    if (std::abs(area) < 2.f)
+    {
+        return;
+    }
+
+    if (area < 0.f)
+    {
+        std::swap(v1, v2);
+        area = -area;
+    }
+
+    Triangle triangle;
+    std::array<glm::vec3, 3> v{v0, v1, v2};
+
+    for (size_t e = 0; e < 3; ++e)
+    {
+        const glm::vec3& a = v[e];
+        const glm::vec3& b = v[(e + 1) % 3];
+
+        // Evaluated at the pixel center, lowered to the pixel corner farthest outside
+        triangle.edge_x[e] = a.y - b.y;
+        triangle.edge_y[e] = b.x - a.x;
+        triangle.edge_offset[e] = a.x * b.y - a.y * b.x - 0.5f * (std::abs(triangle.edge_x[e]) + std::abs(triangle.edge_y[e]));
+    }
+
+    // Depth is affine in screen space, raised to the pixel corner farthest away
+    triangle.depth_x = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+    triangle.depth_y = ((v1.x - v0.x) * (v2.z - v0.z) - (v2.x - v0.x) * (v1.z - v0.z)) / area;
+    triangle.depth_offset = v0.z - triangle.depth_x * v0.x - triangle.depth_y * v0.y + 0.5f * (std::abs(triangle.depth_x) + std::abs(triangle.depth_y));
+
+    // Clamped as floats first, the corners may be far outside the buffer
+    auto to_pixel = [](GLfloat coordinate, GLuint size) {
+        return GLint(std::clamp(std::floor(coordinate), -1.f, GLfloat(size)));
+    };
+
+    triangle.min_x = std::max(to_pixel(std::min({v0.x, v1.x, v2.x}), width), 0);
+    triangle.max_x = std::min(to_pixel(std::max({v0.x, v1.x, v2.x}), width), GLint(width) - 1);
+    triangle.min_y = std::max(to_pixel(std::min({v0.y, v1.y, v2.y}), height), 0);
+    triangle.max_y = std::min(to_pixel(std::max({v0.y, v1.y, v2.y}), height), GLint(height) - 1);
+
+    if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y)
+    {
+        return;
+    }
+
+    triangles.push_back(triangle);
+}
+
+void SoftwareOcclusion::rasterize_band(GLuint first_row, GLuint last_row) noexcept
+{
+    std::fill(depth.begin() + first_row * width, depth.begin() + last_row * width, 1.f);
+
+    for (const Triangle& triangle: triangles)
+    {
+        GLint row_begin = std::max<GLint>(triangle.min_y, first_row);
+        GLint row_end = std::min<GLint>(triangle.max_y + 1, last_row);
+
+        for (GLint y = row_begin; y < row_end; ++y)
+        {
+            GLfloat center_y = y + 0.5f;
+            GLfloat* row = &depth[y * width];
+
+            std::array<GLfloat, 3> edge_row;
+
+            for (size_t e = 0; e < 3; ++e)
+            {
+                edge_row[e] = triangle.edge_y[e] * center_y + triangle.edge_offset[e];
+            }
+
+            GLfloat depth_row = triangle.depth_y * center_y + triangle.depth_offset;
+
+#if defined(SKYBOX_SIMD) && defined(__SSE2__)
+            // Four pixels at a time from a multiple of four, the buffer width being one too
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            const __m128 edge_x0 = _mm_set1_ps(triangle.edge_x[0]), edge_row0 = _mm_set1_ps(edge_row[0]);
+            const __m128 edge_x1 = _mm_set1_ps(triangle.edge_x[1]), edge_row1 = _mm_set1_ps(edge_row[1]);
+            const __m128 edge_x2 = _mm_set1_ps(triangle.edge_x[2]), edge_row2 = _mm_set1_ps(edge_row[2]);
+            const __m128 depth_x = _mm_set1_ps(triangle.depth_x), depth_row4 = _mm_set1_ps(depth_row);
+
+            for (GLint x = triangle.min_x & ~3; x <= triangle.max_x; x += 4)
+            {
+                __m128 center_x = _mm_add_ps(_mm_set1_ps(GLfloat(x)), offsets);
+                __m128 inside = _mm_and_ps(_mm_and_ps(
+                    _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_x0, center_x), edge_row0), zero),
+                    _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_x1, center_x), edge_row1), zero)),
+                    _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_x2, center_x), edge_row2), zero));
+
+                if (_mm_movemask_ps(inside) == 0)
+                {
+                    continue;
+                }
+
+                __m128 current = _mm_loadu_ps(row + x);
+                __m128 nearer = _mm_min_ps(current, _mm_add_ps(_mm_mul_ps(depth_x, center_x), depth_row4));
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+            }
+#else
+            for (GLint x = triangle.min_x; x <= triangle.max_x; ++x)
+            {
+                GLfloat center_x = x + 0.5f;
+
+                if (triangle.edge_x[0] * center_x + edge_row[0] >= 0.f &&
+                    triangle.edge_x[1] * center_x + edge_row[1] >= 0.f &&
+                    triangle.edge_x[2] * center_x + edge_row[2] >= 0.f)
+                {
+                    row[x] = std::min(row[x], triangle.depth_x * center_x + depth_row);
+                }
+            }
+#endif
+        }
+    }
+
+    for (GLuint tile_y = first_row / TILE_SIZE; tile_y < last_row / TILE_SIZE; ++tile_y)
+    {
+        for (GLuint tile_x = 0; tile_x < tiles_x; ++tile_x)
+        {
+            const GLfloat* tile = &depth[tile_y * TILE_SIZE * width + tile_x * TILE_SIZE];
+
+#if defined(SKYBOX_SIMD) && defined(__SSE2__)
+            __m128 farthest = _mm_setzero_ps();
+
+            for (GLuint y = 0; y < TILE_SIZE; ++y)
+            {
+                for (GLuint x = 0; x < TILE_SIZE; x += 4)
+                {
+                    farthest = _mm_max_ps(farthest, _mm_loadu_ps(tile + y * width + x));
+                }
+            }
+
+            farthest = _mm_max_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(2, 3, 0, 1)));
+            farthest = _mm_max_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(1, 0, 3, 2)));
+            tile_depth[tile_y * tiles_x + tile_x] = _mm_cvtss_f32(farthest);
+#else
+            GLfloat farthest = 0.f;
+
+            for (GLuint y = 0; y < TILE_SIZE; ++y)
+            {
+                for (GLuint x = 0; x < TILE_SIZE; ++x)
+                {
+                    farthest = std::max(farthest, tile[y * width + x]);
+                }
+            }
+
+            tile_depth[tile_y * tiles_x + tile_x] = farthest;
+#endif
+        }
+    }
+}
+
+bool SoftwareOcclusion::is_visible(const BoundingBox& bounds) noexcept
+{
+    if (!rendered || bounds.is_empty())
+    {
+        return true;
+    }
+
+    ++num_tested;
+
+    GLfloat min_x = std::numeric_limits<GLfloat>::max();
+    GLfloat min_y = std::numeric_limits<GLfloat>::max();
+    GLfloat max_x = std::numeric_limits<GLfloat>::lowest();
+    GLfloat max_y = std::numeric_limits<GLfloat>::lowest();
+    GLfloat nearest = std::numeric_limits<GLfloat>::max();
+
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner{
+            (i & 1) ? bounds.get_max().x : bounds.get_min().x,
+            (i & 2) ? bounds.get_max().y : bounds.get_min().y,
+            (i & 4) ? bounds.get_max().z : bounds.get_min().z
+        };
+        glm::vec4 clip = view_projection * glm::vec4{corner, 1.f};
+
+        // Reaching in front of the near plane, where nothing was rasterized
+        if (clip.w <= 0.f || clip.z < -clip.w)
+        {
+            return true;
+        }
+
+        GLfloat x = (clip.x / clip.w * 0.5f + 0.5f) * width;
+        GLfloat y = (clip.y / clip.w * 0.5f + 0.5f) * height;
+
+        min_x = std::min(min_x, x);
+        min_y = std::min(min_y, y);
+        max_x = std::max(max_x, x);
+        max_y = std::max(max_y, y);
+        nearest = std::min(nearest, clip.z / clip.w * 0.5f + 0.5f);
+    }
+
+    // Off the buffer altogether is for the frustum test to decide
+    if (max_x < 0.f || max_y < 0.f || min_x >= width || min_y >= height)
+    {
+        return true;
+    }
+
+    // Every pixel the box touches, partly covered ones included
+    GLuint first_x = GLuint(std::max(min_x, 0.f));
+    GLuint first_y = GLuint(std::max(min_y, 0.f));
+    GLuint last_x = GLuint(std::min(max_x, GLfloat(width - 1)));
+    GLuint last_y = GLuint(std::min(max_y, GLfloat(height - 1)));
+
+    for (GLuint tile_y = first_y / TILE_SIZE; tile_y <= last_y / TILE_SIZE; ++tile_y)
+    {
+        for (GLuint tile_x = first_x / TILE_SIZE; tile_x <= last_x / TILE_SIZE; ++tile_x)
+        {
+            // The whole tile is nearer than the box
+            if (tile_depth[tile_y * tiles_x + tile_x] < nearest)
+            {
+                continue;
+            }
+
+            GLuint row_end = std::min(last_y, (tile_y + 1) * TILE_SIZE - 1);
+            GLuint column_end = std::min(last_x, (tile_x + 1) * TILE_SIZE - 1);
+
+            for (GLuint y = std::max(first_y, tile_y * TILE_SIZE); y <= row_end; ++y)
+            {
+                for (GLuint x = std::max(first_x, tile_x * TILE_SIZE); x <= column_end; ++x)
+                {
+                    if (depth[y * width + x] >= nearest)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    ++num_hidden;
+
+    return false;
+}
+
+void SoftwareOcclusion::end_frame() noexcept
+{
+    if (++num_frames < REPORT_INTERVAL)
+    {
+        return;
+    }
+
+    LOG_INIT_COUT();
+    log(LOG_INFO) << name << ": " << double(num_triangles) / num_frames << " occluder triangles, "
+                  << double(num_tested) / num_frames << " boxes tested and " << double(num_hidden) / num_frames << " hidden per frame\n";
+
+    num_frames = 0;
+    num_triangles = 0;
+    num_tested = 0;
+    num_hidden = 0;
+}
\ No newline at end of file
@@ -1,16 +1,26 @@
-#include <SpotLight.hpp>
+#include <cmath>
+
+#include <glm/gtc/constants.hpp>
 
+#include <Frustum.hpp>
+#include <SpotLight.hpp>
 
-SpotLight::SpotLight(GLuint shadow_width, GLuint shadow_height,
+SpotLight::SpotLight(std::shared_ptr<ShadowAtlas> shadow_atlas,
                      GLfloat near, GLfloat far,
                      GLfloat red, GLfloat green, GLfloat blue, GLfloat _ambient_intensity, GLfloat _diffuse_intensity,
                      GLfloat pos_x, GLfloat pos_y, GLfloat pos_z, GLfloat _a, GLfloat _b, GLfloat _c,
                      GLfloat dir_x, GLfloat dir_y, GLfloat dir_z, GLfloat _edge) noexcept
-    : PointLight{shadow_width, shadow_height, near, far, red, green, blue, _ambient_intensity, _diffuse_intensity, pos_x, pos_y, pos_z, _a, _b, _c},
+    : PointLight{near, far, red, green, blue, _ambient_intensity, _diffuse_intensity, pos_x, pos_y, pos_z, _a, _b, _c},
       direction{dir_x, dir_y, dir_z}, edge{_edge}
 {
     direction = glm::normalize(direction);
     proc_edge = cosf(glm::radians(edge));
+
+    // A single frustum around the cone, with a small margin for the PCF kernel.
+    // Atlas tiles are square and sized every frame by the screen coverage.
+    float fov = std::min(2.f * edge + 2.f, 170.f);
+    projection = glm::perspective(glm::radians(fov), 1.f, near, far);
+    shadow_map = std::make_shared<AtlasShadowMap>(shadow_atlas);
 }
 
 SpotLight::~SpotLight()
@@ -29,6 +39,40 @@ void SpotLight::use(GLuint color_id, GLuint ambient_intensity_id, GLuint diffuse
 
 void SpotLight::set(const glm::vec3& pos, const glm::vec3& dir) noexcept
 {
+    glm::vec3 new_direction = glm::normalize(dir);
+
+    if (pos != position || new_direction != direction)
+    {
+        shadow_map->mark_dirty();
+        ++version;
+    }
+
     position = pos;
-    direction = dir;
+    direction = new_direction;
+}
+
+glm::mat4 SpotLight::get_light_transform() const noexcept
+{
+    glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3{0.f, 0.f, 1.f} : glm::vec3{0.f, 1.f, 0.f};
+    return projection * glm::lookAt(position, position + direction, up);
+}
+
+bool SpotLight::shadow_volume_intersects(const BoundingBox& bounds) const noexcept
+{
+    return Frustum{get_light_transform()}.intersects(bounds);
+}
+
+glm::vec4 SpotLight::get_bounding_sphere() const noexcept
+{
+    GLfloat range = get_range();
+    GLfloat angle = glm::radians(edge);
+
+    // Wide cones are bounded by their base circle, narrow ones by the sphere through apex and rim
+    if (angle > glm::quarter_pi<float>())
+    {
+        return glm::vec4{position + direction * (range * std::cos(angle)), range * std::sin(angle)};
+    }
+
+    GLfloat radius = range / (2.f * std::cos(angle));
+    return glm::vec4{position + direction * radius, radius};
 }
\ No newline at end of file
@@ -23,15 +23,24 @@ std::shared_ptr<Window> Window::create(GLint width, GLint height, std::string_vi
     }
 
     // Setup GLFW window properties
-    // OpenGL version
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     // No backward compatibility
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     // Allow forward compatibility
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 
-    window->window = glfwCreateWindow(width, height, title.data(), nullptr, nullptr);
+    // Newest OpenGL version first, creation fails for any the driver lacks
+    for (auto [major, minor]: CONTEXT_VERSIONS)
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, major);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minor);
+
+        window->window = glfwCreateWindow(width, height, title.data(), nullptr, nullptr);
+
+        if (window->window)
+        {
+            break;
+        }
+    }
 
     if (!window->window)
     {
@@ -39,6 +48,15 @@ std::shared_ptr<Window> Window::create(GLint width, GLint height, std::string_vi
         glfwTerminate();
         return nullptr;
     }
+
+    // The driver may hand out a newer version than the one asked for
+    window->context_major_version = glfwGetWindowAttrib(window->window, GLFW_CONTEXT_VERSION_MAJOR);
+    window->context_minor_version = glfwGetWindowAttrib(window->window, GLFW_CONTEXT_VERSION_MINOR);
+
+    {
+        LOG_INIT_COUT();
+        log(LOG_INFO) << "OpenGL " << window->context_major_version << "." << window->context_minor_version << " core context\n";
+    }
     
     // Set context for GLEW
     glfwMakeContextCurrent(window->window);
@@ -59,6 +77,9 @@ std::shared_ptr<Window> Window::create(GLint width, GLint height, std::string_vi
 
     glEnable(GL_DEPTH_TEST);
 
+    // Lets cube map lookups and the shadow blur filter across faces
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
     // Setup viewport
     glViewport(0, 0, window->buffer_width, window->buffer_height);
 
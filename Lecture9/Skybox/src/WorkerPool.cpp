@@ -0,0 +1,111 @@
+#include <algorithm>
+
+#include <WorkerPool.hpp>
+
+std::weak_ptr<WorkerPool> WorkerPool::instance{};
+
+std::shared_ptr<WorkerPool> WorkerPool::get_instance() noexcept
+{
+    auto pool = instance.lock();
+
+    if (!pool)
+    {
+        pool = std::make_shared<WorkerPool>(std::max(1u, std::thread::hardware_concurrency()));
+        instance = pool;
+    }
+
+    return pool;
+}
+
+WorkerPool::WorkerPool(size_t num_workers) noexcept
+{
+    for (size_t i = 1; i < num_workers; ++i)
+    {
+        threads.emplace_back(&WorkerPool::work, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (auto& thread: threads)
+    {
+        thread.join();
+    }
+}
+
+void WorkerPool::run(size_t _num_tasks, const Task& _task) noexcept
+{
+    if (threads.empty() || _num_tasks < 2)
+    {
+        for (size_t i = 0; i < _num_tasks; ++i)
+        {
+            _task(i);
+        }
+
+        return;
+    }
+
+    {
+        // A worker that woke late for the previous job may still be looking for tasks
+        std::unique_lock<std::mutex> lock{mutex};
+        done.wait(lock, [this]() { return active == 0; });
+
+        task = &_task;
+        num_tasks = _num_tasks;
+        next_task = 0;
+        ++job;
+    }
+
+    wake.notify_all();
+
+    for (size_t i = next_task++; i < _num_tasks; i = next_task++)
+    {
+        _task(i);
+    }
+
+    // Every task is taken by now, so once no worker is active all of them are done
+    std::unique_lock<std::mutex> lock{mutex};
+    done.wait(lock, [this]() { return active == 0; });
+}
+
+void WorkerPool::work() noexcept
+{
+    size_t last_job = 0;
+    std::unique_lock<std::mutex> lock{mutex};
+
+    while (true)
+    {
+        wake.wait(lock, [this, last_job]() { return stopping || job != last_job; });
+
+        if (stopping)
+        {
+            return;
+        }
+
+        // A worker waking after its job finished finds no task left and never touches the stale task
+        last_job = job;
+        const Task* current_task = task;
+        size_t current_num_tasks = num_tasks;
+        ++active;
+        lock.unlock();
+
+        for (size_t i = next_task++; i < current_num_tasks; i = next_task++)
+        {
+            (*current_task)(i);
+        }
+
+        lock.lock();
+
+        if (--active == 0)
+        {
+            done.notify_one();
+        }
+    }
+}
\ No newline at end of file